@@ -0,0 +1,393 @@
+// Benchmark of every planner on every colony: repeated, non-interactive runs timed with
+// steady_clock, summarized per phase and written as JSON to compare versions.
+#include "ants.hpp"
+#include "batch.hpp"
+#include "compiled_colony.hpp"
+#include "mapped_file.hpp"
+#include "output.hpp"
+#include "solvers.hpp"
+#include "uneviedefourmi.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+
+#ifndef BENCHMARK_COLONY_DIR
+#define BENCHMARK_COLONY_DIR "."
+#endif
+
+namespace {
+
+// Every heap allocation of the process goes through the operator new below
+atomic<uint64_t> allocationCount(0);
+
+} // namespace
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* block = malloc(size ? size : 1)) return block;
+    throw bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// One planner as benchmarked: a solver name and, for greedy, a path strategy and planner thread count
+struct Planner {
+    string label;
+    string solver;
+    PathStrategy strategy;
+    size_t threads;
+};
+
+// Timings of one phase over all the repetitions
+struct PhaseTimes {
+    const char* name;
+    vector<double> samples;
+};
+
+struct Measurement {
+    string colony;
+    string planner;
+    string status = "ok";
+    int numAnts = 0;
+    size_t rooms = 0;
+    int64_t steps = 0;
+    int64_t moves = 0;
+    uint64_t planningAllocations = 0; // Heap allocations of the last planning phase
+    uint64_t stepAllocations = 0;     // Heap allocations of Simulation::step() once settled
+    int64_t measuredSteps = -1;       // Steps they were counted over, -1 until measured
+    PhaseTimes load = {"load", {}};
+    PhaseTimes graphBuild = {"graph_build", {}};
+    PhaseTimes planning = {"planning", {}};
+    PhaseTimes output = {"output", {}};
+};
+
+// Nearest-rank percentile of sorted samples
+double percentile(const vector<double>& sorted, double fraction) {
+    size_t rank = size_t(ceil(fraction * sorted.size()));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+double median(const vector<double>& sorted) {
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+// Steps left out of allocations_per_step: the first ones may still size the simulation's buffers
+const int SETTLING_STEPS = 3;
+
+// Heap allocations of Simulation::step() alone, counted over every step after the settling ones
+void measureStepAllocations(const ColonyInfo& colony, const Planner& planner, Measurement& result) {
+    SimulationOptions options;
+    options.solver = planner.solver;
+    options.strategy = planner.strategy;
+    options.plannerThreads = planner.threads;
+    Simulation simulation(colony, options);
+    result.measuredSteps = 0;
+    if (!simulation.reachable()) return;
+    for (int i = 0; i < SETTLING_STEPS; i++) {
+        if (simulation.step().empty()) return;
+    }
+    uint64_t allocationsBefore = allocationCount.load(memory_order_relaxed);
+    int64_t steps = 0;
+    while (!simulation.step().empty()) steps++;
+    result.stepAllocations = allocationCount.load(memory_order_relaxed) - allocationsBefore;
+    result.measuredSteps = steps;
+}
+
+// Load, build, plan and print once; false if the colony cannot be loaded or solved
+bool runOnce(const string& file, const Planner& planner, FILE* sink, Measurement& result, bool record) {
+    ColonyInfo colony;
+
+    auto start = Clock::now();
+    shared_ptr<MappedFile> mapping = make_shared<MappedFile>();
+    if (!mapping->open(file)) {
+        cerr << "Error: unable to open file " << file << endl;
+        result.status = "load error";
+        return false;
+    }
+    bool compiled = isCompiledColony(mapping->data(), mapping->size());
+    bool loaded = compiled ? bindCompiledColony(colony, mapping) : parseColony(colony, mapping->data(), mapping->size());
+    double loadTime = secondsSince(start);
+    if (!loaded) {
+        result.status = "load error";
+        return false;
+    }
+
+    // A compiled colony already holds its graph
+    start = Clock::now();
+    if (!compiled) buildTunnelGraph(colony);
+    double buildTime = secondsSince(start);
+
+    Schedule schedule;
+    int64_t steps = 0;
+    int64_t moves = 0;
+    bool solved;
+    uint64_t allocationsBefore = allocationCount.load(memory_order_relaxed);
+    start = Clock::now();
+    bool aggregate = planner.solver == "aggregate" || planner.solver == "events";
+    if (aggregate) {
+        solved = countAggregateSteps(colony, steps, moves, planner.solver == "events");
+    } else {
+        solved = solveColony(colony, planner.solver, schedule, planner.threads, planner.strategy);
+    }
+    double planTime = secondsSince(start);
+    uint64_t planningAllocations = allocationCount.load(memory_order_relaxed) - allocationsBefore;
+    if (!solved) {
+        result.status = "no path";
+        return false;
+    }
+
+    // The aggregate engine prints while it plans, so only full schedules have an output phase
+    double outputTime = 0;
+    if (!aggregate) {
+        steps = schedule.size();
+        for (const vector<Move>& step : schedule) {
+            moves += step.size();
+        }
+        start = Clock::now();
+        {
+            OutputWriter out(sink);
+            printSchedule(out, colony, schedule);
+        }
+        outputTime = secondsSince(start);
+    }
+
+    if (record) {
+        result.numAnts = colony.numAnts;
+        result.rooms = colony.roomCount();
+        result.steps = steps;
+        result.moves = moves;
+        result.planningAllocations = planningAllocations;
+        result.load.samples.push_back(loadTime);
+        result.graphBuild.samples.push_back(buildTime);
+        result.planning.samples.push_back(planTime);
+        if (!aggregate) result.output.samples.push_back(outputTime);
+        if (result.measuredSteps < 0) measureStepAllocations(colony, planner, result);
+    }
+    return true;
+}
+
+void writePhase(OutputWriter& out, PhaseTimes& phase, bool last) {
+    out << "        ";
+    writeJsonString(out, phase.name);
+    if (phase.samples.empty()) {
+        out << ": null";
+    } else {
+        sort(phase.samples.begin(), phase.samples.end());
+        out << ": {\"min\": ";
+        out.writeFixed(phase.samples.front(), 9);
+        out << ", \"median\": ";
+        out.writeFixed(median(phase.samples), 9);
+        out << ", \"p99\": ";
+        out.writeFixed(percentile(phase.samples, 0.99), 9);
+        out << '}';
+    }
+    out << (last ? "\n" : ",\n");
+}
+
+void writeReport(OutputWriter& out, vector<Measurement>& results, int warmups, int repetitions) {
+    out << "{\n";
+    out << "  \"format\": 1,\n";
+    out << "  \"unix_time\": " << int64_t(time(nullptr)) << ",\n";
+    out << "  \"warmups\": " << warmups << ",\n";
+    out << "  \"repetitions\": " << repetitions << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        Measurement& result = results[i];
+        out << "    {\n";
+        out << "      \"colony\": ";
+        writeJsonString(out, result.colony);
+        out << ",\n      \"planner\": ";
+        writeJsonString(out, result.planner);
+        out << ",\n      \"status\": ";
+        writeJsonString(out, result.status);
+        out << ",\n      \"ants\": " << result.numAnts << ",\n";
+        out << "      \"rooms\": " << result.rooms << ",\n";
+        out << "      \"steps\": " << result.steps << ",\n";
+        out << "      \"moves\": " << result.moves << ",\n";
+        out << "      \"planning_allocations\": " << size_t(result.planningAllocations) << ",\n";
+        out << "      \"allocations_per_step\": ";
+        if (result.measuredSteps > 0) {
+            out.writeFixed(double(result.stepAllocations) / result.measuredSteps, 3);
+        } else {
+            out << "null";
+        }
+        out << ",\n";
+        out << "      \"moves_per_second\": ";
+        if (result.planning.samples.empty()) {
+            out << "null";
+        } else {
+            vector<double> sorted = result.planning.samples;
+            sort(sorted.begin(), sorted.end());
+            double planTime = median(sorted);
+            if (planTime > 0) {
+                out.writeFixed(result.moves / planTime, 1);
+            } else {
+                out << "null";
+            }
+        }
+        out << ",\n      \"phases\": {\n";
+        writePhase(out, result.load, false);
+        writePhase(out, result.graphBuild, false);
+        writePhase(out, result.planning, false);
+        writePhase(out, result.output, true);
+        out << "      }\n";
+        out << (i + 1 < results.size() ? "    },\n" : "    }\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool parseCount(const string& text, long minimum, long& value) {
+    char* end;
+    value = strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && value >= minimum;
+}
+
+void printUsage() {
+    cerr << "Usage: uneviedefourmi_bench [--warmup=N] [--reps=N] [--solvers=a,b,...] [--strategies=a,b,...] [--threads=N]"
+         << " [--output=FILE] [directories or colony files...]" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long warmups = 1;
+    long repetitions = 5;
+    long plannerThreads = 0;
+    string outputFile;
+    vector<string> solvers = solverNames();
+    vector<PathStrategy> strategies;
+    for (int i = 0; i < STRATEGY_COUNT; i++) strategies.push_back(PathStrategy(i));
+    vector<string> files;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 9, "--warmup=") == 0) {
+            if (!parseCount(arg.substr(9), 0, warmups)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg.compare(0, 7, "--reps=") == 0) {
+            if (!parseCount(arg.substr(7), 1, repetitions)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg.compare(0, 10, "--threads=") == 0) {
+            if (!parseCount(arg.substr(10), 1, plannerThreads)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg.compare(0, 10, "--solvers=") == 0) {
+            solvers.clear();
+            stringstream list(arg.substr(10));
+            string solver;
+            while (getline(list, solver, ',')) {
+                if (!isKnownSolver(solver)) {
+                    cerr << "Error: unknown solver " << solver << endl;
+                    return 1;
+                }
+                solvers.push_back(solver);
+            }
+        } else if (arg.compare(0, 13, "--strategies=") == 0) {
+            strategies.clear();
+            stringstream list(arg.substr(13));
+            string name;
+            while (getline(list, name, ',')) {
+                PathStrategy strategy;
+                if (!parseStrategy(name, strategy)) {
+                    cerr << "Error: unknown strategy " << name << endl;
+                    return 1;
+                }
+                strategies.push_back(strategy);
+            }
+        } else if (arg.compare(0, 9, "--output=") == 0) {
+            outputFile = arg.substr(9);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            printUsage();
+            return 1;
+        } else if (!expandColonyPath(arg, files)) {
+            return 1;
+        }
+    }
+    if (files.empty() && !expandColonyPath(BENCHMARK_COLONY_DIR, files)) {
+        return 1;
+    }
+
+    // The greedy engine is benchmarked once per path strategy, on the same simulation core
+    vector<Planner> planners;
+    for (const string& solver : solvers) {
+        if (solver != "greedy") {
+            planners.push_back({solver, solver, STRATEGY_BFS, 0});
+            continue;
+        }
+        for (PathStrategy strategy : strategies) {
+            string label = string("greedy/") + strategyName(strategy);
+            planners.push_back({label, solver, strategy, 0});
+            if (strategy == STRATEGY_BFS && plannerThreads > 0) {
+                planners.push_back({label + "/threads=" + to_string(plannerThreads), solver, strategy, size_t(plannerThreads)});
+            }
+        }
+    }
+
+    // Printed moves go nowhere, only the formatting and writing is measured
+    FILE* sink = fopen("/dev/null", "w");
+    if (!sink) {
+        cerr << "Error: unable to open /dev/null" << endl;
+        return 1;
+    }
+
+    vector<Measurement> results;
+    for (const string& file : files) {
+        for (const Planner& planner : planners) {
+            Measurement result;
+            result.colony = file;
+            result.planner = planner.label;
+            bool ok = true;
+            for (long run = 0; ok && run < warmups + repetitions; run++) {
+                ok = runOnce(file, planner, sink, result, run >= warmups);
+            }
+            results.push_back(result);
+
+            cerr << file << " [" << planner.label << "] " << result.status;
+            if (ok) {
+                vector<double> sorted = result.planning.samples;
+                sort(sorted.begin(), sorted.end());
+                cerr << ", " << result.steps << " steps, planning median " << median(sorted) << " s, "
+                     << result.planningAllocations << " allocations";
+            }
+            cerr << endl;
+        }
+    }
+    fclose(sink);
+
+    FILE* stream = outputFile.empty() ? stdout : fopen(outputFile.c_str(), "w");
+    if (!stream) {
+        cerr << "Error: unable to write file " << outputFile << endl;
+        return 1;
+    }
+    {
+        OutputWriter out(stream);
+        writeReport(out, results, warmups, repetitions);
+    }
+    if (stream != stdout) fclose(stream);
+    return 0;
+}
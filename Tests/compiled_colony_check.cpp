@@ -0,0 +1,87 @@
+// A compiled colony whose rows, tunnel ids or distances point outside the colony must be refused
+// by bindCompiledColony instead of crashing whatever plans on it: a sample colony is compiled, then
+// each section is corrupted in turn in a copy of the file.
+#include "compiled_colony.hpp"
+#include "mapped_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#ifndef SAMPLE_COLONY_DIR
+#define SAMPLE_COLONY_DIR "."
+#endif
+
+namespace {
+
+bool readFile(const string& filename, string& bytes) {
+    ifstream in(filename, ios::binary);
+    if (!in) return false;
+    bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return true;
+}
+
+bool writeFile(const string& filename, const string& bytes) {
+    ofstream out(filename, ios::binary | ios::trunc);
+    out.write(bytes.data(), bytes.size());
+    return bool(out);
+}
+
+bool binds(const string& filename) {
+    shared_ptr<MappedFile> mapping = make_shared<MappedFile>();
+    if (!mapping->open(filename)) return false;
+    ColonyInfo colony;
+    return bindCompiledColony(colony, mapping);
+}
+
+template <typename T>
+void patch(string& bytes, uint64_t at, T value) {
+    memcpy(&bytes[at], &value, sizeof(value));
+}
+
+} // namespace
+
+int main() {
+    string filename = "compiled_colony_check_" + to_string(getpid()) + ".uvc";
+    ColonyInfo colony;
+    string compiled;
+    if (!loadColonyFromFile(colony, string(SAMPLE_COLONY_DIR) + "/fourmiliere_quatre.txt") ||
+        !writeCompiledColony(colony, filename) || !readFile(filename, compiled)) {
+        cerr << "Error: unable to compile the sample colony" << endl;
+        return 1;
+    }
+    CompiledColonyHeader header;
+    memcpy(&header, compiled.data(), sizeof(header));
+
+    struct Corruption {
+        const char* name;
+        uint64_t at;
+        uint32_t value;
+    };
+    const Corruption corruptions[] = {
+        {"tunnel id past the last room", header.tunnelsAt, 100000},
+        {"decreasing tunnel offsets", header.tunnelOffsetsAt + sizeof(uint32_t), uint32_t(header.tunnelCount)},
+        {"name offset past the names", header.nameOffsetsAt + sizeof(uint32_t), uint32_t(header.nameBytes + 1)},
+        {"negative distance", header.distanceAt, uint32_t(-2)},
+        {"distance past the room count", header.distanceAt, uint32_t(header.roomCount + 1)},
+    };
+
+    int failed = 0;
+    if (!binds(filename)) {
+        cerr << "the intact compiled colony was refused" << endl;
+        failed++;
+    }
+    for (const Corruption& corruption : corruptions) {
+        string bytes = compiled;
+        patch(bytes, corruption.at, corruption.value);
+        if (!writeFile(filename, bytes)) return 1;
+        if (binds(filename)) {
+            cerr << "accepted a compiled colony with a " << corruption.name << endl;
+            failed++;
+        }
+    }
+    remove(filename.c_str());
+
+    cout << (failed == 0 ? "every corrupted compiled colony was refused" : "some corrupted compiled colonies were accepted") << endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+// The incremental dijkstra strategy must plan exactly the moves of dijkstra-scratch, the full
+// search it replaces: both are run step by step on the sample colonies and on generated ones of
+// every family, and the first step where they part is reported.
+#include "generator.hpp"
+#include "output.hpp"
+#include "uneviedefourmi.hpp"
+
+#ifndef SAMPLE_COLONY_DIR
+#define SAMPLE_COLONY_DIR "."
+#endif
+
+namespace {
+
+const char* const SAMPLES[] = {"fourmiliere_zero.txt", "fourmiliere_un.txt", "fourmiliere_deux.txt",
+                               "fourmiliere_trois.txt", "fourmiliere_quatre.txt", "fourmiliere_cinq.txt",
+                               "fourmiliere_3D.txt", "everything_everywhere.txt"};
+const char* const FAMILIES[] = {"grid", "lattice", "random", "chain", "fanout"};
+const uint64_t SEEDS = 4;
+
+bool sameMove(const Move& a, const Move& b) {
+    return a.ant == b.ant && a.from == b.from && a.to == b.to;
+}
+
+// False, with the step where they differ, when the two strategies do not move the same ants
+bool strategiesMatch(const Colony& colony, const string& name) {
+    SimulationOptions incremental;
+    incremental.strategy = STRATEGY_DIJKSTRA;
+    SimulationOptions scratch;
+    scratch.strategy = STRATEGY_DIJKSTRA_SCRATCH;
+    Simulation a(colony, incremental);
+    Simulation b(colony, scratch);
+    if (a.reachable() != b.reachable()) {
+        cerr << name << ": only one strategy reaches Sd" << endl;
+        return false;
+    }
+    if (!a.reachable()) return true;
+
+    while (true) {
+        ArrayView<Move> movesA = a.step(); // Each view stays valid until its own simulation steps again
+        ArrayView<Move> movesB = b.step();
+        bool same = movesA.size() == movesB.size();
+        for (size_t i = 0; same && i < movesA.size(); i++) same = sameMove(movesA[i], movesB[i]);
+        if (!same) {
+            cerr << name << ": step " << a.stepCount() << " differs (" << movesA.size() << " moves against "
+                 << movesB.size() << ")" << endl;
+            return false;
+        }
+        if (movesA.empty()) return true;
+    }
+}
+
+} // namespace
+
+int main() {
+    int checked = 0;
+    int failed = 0;
+
+    for (const char* sample : SAMPLES) {
+        string file = string(SAMPLE_COLONY_DIR) + "/" + sample;
+        Colony colony;
+        if (!colony.load(file)) {
+            cerr << "Error: unable to load " << file << endl;
+            return 1;
+        }
+        checked++;
+        failed += !strategiesMatch(colony, sample);
+    }
+
+    for (const char* family : FAMILIES) {
+        for (uint64_t seed = 1; seed <= SEEDS; seed++) {
+            GeneratorOptions options;
+            options.family = family;
+            options.rooms = 300;
+            options.ants = 120;
+            options.minCapacity = 1;
+            options.maxCapacity = 3;
+            options.seed = seed;
+            string text;
+            {
+                OutputWriter out(text);
+                if (!generateColony(out, options)) return 1;
+            }
+            Colony colony;
+            if (!colony.parse(text.data(), text.size())) return 1;
+            checked++;
+            failed += !strategiesMatch(colony, string(family) + " seed " + to_string(seed));
+        }
+    }
+
+    cout << checked - failed << " of " << checked << " colonies planned the same by dijkstra and dijkstra-scratch" << endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include "aggregate.hpp"
+#include "stats.hpp"
+
+size_t AggregateStep::moveCount() const {
+    size_t total = 0;
+    for (const Batch& batch : batches) {
+        total += batch.count;
+    }
+    return total;
+}
+
+AggregateSimulation::AggregateSimulation(const ColonyInfo& colony, bool eventDriven) : colony(colony), eventDriven(eventDriven) {
+    size_t numRooms = colony.roomCount();
+    int numAnts = colony.numAnts;
+    waiting = max(numAnts, 0);
+    arrived = 0;
+
+    // Rooms with no capacity would only trap ants, so distances go around them
+    distance.assign(numRooms, UNREACHABLE);
+    vector<RoomId> frontier;
+    frontier.push_back(DORMITORY);
+    distance[DORMITORY] = 0;
+    for (size_t head = 0; head < frontier.size(); head++) {
+        RoomId room = frontier[head];
+        if (room == VESTIBULE) continue;
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (distance[neighbor] != UNREACHABLE) continue;
+            if (neighbor != VESTIBULE && colony.roomCapacity[neighbor] <= 0) continue;
+            distance[neighbor] = distance[room] + 1;
+            frontier.push_back(neighbor);
+        }
+    }
+
+    // Moves only go one hop closer to Sd, so nothing farther than Sv ever holds an ant
+    int limit = distance[VESTIBULE];
+    for (RoomId room : frontier) {
+        if (room != VESTIBULE && room != DORMITORY && distance[room] < limit) order.push_back(room);
+    }
+    sort(order.begin(), order.end(), [this](RoomId a, RoomId b) {
+        return distance[a] != distance[b] ? distance[a] < distance[b] : a < b;
+    });
+    if (reachable()) order.push_back(VESTIBULE);
+
+    count.assign(numRooms, 0);
+    ringHead.assign(numRooms, 0);
+    ringStart.assign(numRooms + 1, 0);
+    for (RoomId room : order) {
+        if (room != VESTIBULE) ringStart[room + 1] = min(colony.roomCapacity[room], numAnts);
+    }
+    for (size_t room = 0; room < numRooms; room++) {
+        ringStart[room + 1] += ringStart[room];
+    }
+    ring.resize(ringStart[numRooms]);
+
+    if (eventDriven && reachable()) {
+        levelStart.assign(limit + 2, 0);
+        for (RoomId room : order) levelStart[distance[room] + 1]++;
+        for (int d = 0; d <= limit; d++) levelStart[d + 1] += levelStart[d];
+        ready.resize(limit + 1);
+        queuedFor.assign(numRooms, 0);
+        if (waiting > 0) queue(VESTIBULE, 1);
+    }
+}
+
+void AggregateSimulation::push(RoomId room, int ant) {
+    size_t size = ringStart[room + 1] - ringStart[room];
+    ring[ringStart[room] + (ringHead[room] + count[room]) % size] = ant;
+    count[room]++;
+}
+
+int AggregateSimulation::pop(RoomId room) {
+    size_t size = ringStart[room + 1] - ringStart[room];
+    int ant = ring[ringStart[room] + ringHead[room]];
+    ringHead[room] = (ringHead[room] + 1) % size;
+    count[room]--;
+    return ant;
+}
+
+// Room to look at during the given step (this one or the next), once
+void AggregateSimulation::queue(RoomId room, uint64_t step) {
+    if (queuedFor[room] == step) return;
+    queuedFor[room] = step;
+    if (step == stepNumber) {
+        makeReady(room);
+    } else {
+        readyNext.push_back(room);
+    }
+}
+
+void AggregateSimulation::makeReady(RoomId room) {
+    vector<RoomId>& level = ready[distance[room]];
+    if (level.empty()) readyLevels.push(distance[room]);
+    level.push_back(room);
+}
+
+// Send as many ants of the room as fit one hop closer to Sd, in tunnel order
+void AggregateSimulation::moveRoom(RoomId room, AggregateStep& moves) {
+    STAT_INC(STAT_NODES_EXPANDED);
+    int numAnts = colony.numAnts;
+    int& inside = room == VESTIBULE ? waiting : count[room];
+    int before = inside;
+    for (RoomId neighbor : colony.neighbors(room)) {
+        if (inside == 0) break;
+        if (distance[neighbor] != distance[room] - 1) continue;
+
+        int amount = inside;
+        if (neighbor != DORMITORY) {
+            amount = min(amount, colony.roomCapacity[neighbor] - count[neighbor]);
+        }
+        if (amount <= 0) continue;
+
+        Batch batch = {room, neighbor, amount, numAnts - waiting, moves.ants.size()};
+        for (int k = 0; k < amount; k++) {
+            int ant = room == VESTIBULE ? batch.firstAnt + k : pop(room);
+            if (room != VESTIBULE) moves.ants.push_back(ant);
+            if (neighbor != DORMITORY) push(neighbor, ant);
+        }
+        if (room == VESTIBULE) waiting -= amount;
+        if (neighbor == DORMITORY) arrived += amount;
+        moves.batches.push_back(batch);
+        if (eventDriven && neighbor != DORMITORY) queue(neighbor, stepNumber + 1);
+        STAT_ADD(STAT_MOVES_PLANNED, amount);
+    }
+    STAT_ADD(STAT_MOVES_REJECTED, inside);
+
+    // The slots just freed can be taken during this step by the rooms one hop farther from Sd
+    if (!eventDriven || inside == before || room == VESTIBULE) return;
+    int limit = distance[VESTIBULE];
+    for (RoomId neighbor : colony.neighbors(room)) {
+        if (distance[neighbor] != distance[room] + 1) continue;
+        if (neighbor == VESTIBULE ? waiting > 0 : distance[neighbor] < limit && count[neighbor] > 0) queue(neighbor, stepNumber);
+    }
+}
+
+bool AggregateSimulation::step(AggregateStep& moves) {
+    STAT_STEP_TIMER();
+    moves.batches.clear();
+    moves.ants.clear();
+
+    // Closer rooms move first, so the room they free up can be refilled during the same step
+    if (!eventDriven) {
+        for (RoomId room : order) moveRoom(room, moves);
+        return !moves.batches.empty();
+    }
+
+    // Distances in increasing order, rooms of a distance by id as in order: when most of them are
+    // ready the slice of order is scanned, otherwise only the ready ones are sorted
+    stepNumber++;
+    for (RoomId room : readyNext) makeReady(room);
+    readyNext.clear();
+    while (!readyLevels.empty()) {
+        int d = readyLevels.top();
+        readyLevels.pop();
+        vector<RoomId>& level = ready[d];
+        uint32_t first = levelStart[d];
+        uint32_t last = levelStart[d + 1];
+        if (level.size() * 8 >= last - first) {
+            for (uint32_t i = first; i < last; i++) {
+                if (queuedFor[order[i]] == stepNumber) moveRoom(order[i], moves);
+            }
+        } else {
+            sort(level.begin(), level.end());
+            for (RoomId room : level) moveRoom(room, moves);
+        }
+        level.clear();
+    }
+    return !moves.batches.empty();
+}
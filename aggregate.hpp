@@ -0,0 +1,74 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "ants.hpp"
+
+// Ants that go through the same tunnel during a step
+struct Batch {
+    RoomId from;
+    RoomId to;
+    int count;
+    int firstAnt;  // Ants leaving Sv are consecutive: firstAnt .. firstAnt + count - 1
+    size_t queued; // Other batches: their ids are AggregateStep::ants[queued .. queued + count - 1]
+};
+
+// Moves of one step, grouped by tunnel
+struct AggregateStep {
+    vector<Batch> batches;
+    vector<int> ants;
+
+    int antOf(const Batch& batch, int k) const {
+        return batch.from == VESTIBULE ? batch.firstAnt + k : ants[batch.queued + k];
+    }
+    size_t moveCount() const;
+};
+
+// Simulation that keeps a count of ants per room and a FIFO of their ids, never one object per ant.
+// Every step, rooms closest to Sd empty first and send as many ants as fit one hop closer,
+// so memory depends on the rooms and their capacities, not on the number of ants.
+// Ants never take a longer path, even when the shortest ones are full: with many ants and
+// little capacity on the shortest paths, the plan takes more steps than the paths solver's.
+//
+// Event driven (the events solver), the moves are the same but a step only looks at the rooms
+// that may move: those that took in ants during the last step, and those next to a room that
+// freed a slot during this one (ants leave a room before the rooms farther from Sd are looked
+// at, so that is the only way a blocked room gets to move). Ants waiting in Sv are only
+// looked at when a room next to it frees a slot. The work of a step follows its moves instead
+// of the number of rooms holding ants.
+class AggregateSimulation {
+public:
+    AggregateSimulation(const ColonyInfo& colony, bool eventDriven = false);
+
+    bool reachable() const { return distance[VESTIBULE] != UNREACHABLE; }
+    bool finished() const { return arrived == colony.numAnts; }
+    bool step(AggregateStep& moves); // False when no ant could move
+
+private:
+    const ColonyInfo& colony;
+    vector<int> distance;     // Hops to Sd through rooms that can hold an ant
+    vector<RoomId> order;     // Rooms an ant can stand in, closest to Sd first, Sv last
+    vector<int> count;        // Ants inside each room
+    vector<size_t> ringStart; // FIFO of room r is ring[ringStart[r] .. ringStart[r + 1]]
+    vector<size_t> ringHead;
+    vector<int> ring;
+    int waiting;              // Ants still in Sv, the next one to leave is numAnts - waiting
+    int arrived;
+
+    // Event driven only. A room only wakes rooms one hop farther from Sd, so the rooms to look at
+    // are kept by distance and each distance is handled as a whole, in the order of the scan.
+    bool eventDriven;
+    vector<uint32_t> levelStart;   // Rooms of order at distance d are order[levelStart[d] .. levelStart[d + 1]]
+    vector<vector<RoomId>> ready;  // Distance -> rooms to look at during this step
+    priority_queue<int, vector<int>, greater<int>> readyLevels; // Distances with some ready room
+    vector<RoomId> readyNext;      // Rooms to look at during the next step
+    vector<uint64_t> queuedFor;    // Room -> last step it was queued for
+    uint64_t stepNumber = 0;
+
+    void push(RoomId room, int ant);
+    int pop(RoomId room);
+    void queue(RoomId room, uint64_t step);
+    void makeReady(RoomId room);
+    void moveRoom(RoomId room, AggregateStep& moves);
+};
+
+#endif // AGGREGATE_H
@@ -0,0 +1,134 @@
+#include "analysis.hpp"
+#include "bounds.hpp"
+#include "reduction.hpp"
+
+namespace {
+
+void printAnalyzeUsage() {
+    cerr << "Usage: uneviedefourmi analyze [--output=FILE] <colony file>" << endl;
+}
+
+// ["name", ...] on a single line
+void writeRoomNames(OutputWriter& out, const ColonyInfo& colony, const vector<RoomId>& rooms) {
+    out << '[';
+    for (size_t i = 0; i < rooms.size(); i++) {
+        if (i > 0) out << ", ";
+        writeJsonString(out, colony.roomName(rooms[i]));
+    }
+    out << ']';
+}
+
+} // namespace
+
+void writeColonyAnalysis(OutputWriter& out, const ColonyInfo& colony, const string& file) {
+    size_t numRooms = colony.roomCount();
+    BlockStructure structure;
+    findBlocks(colony, vector<char>(numRooms, 1), structure);
+    vector<RoomId> articulationPoints;
+    for (RoomId room = 0; room < numRooms; room++) {
+        if (structure.articulation[room]) articulationPoints.push_back(room);
+    }
+
+    ColonyReduction reduction;
+    reduceColony(colony, reduction);
+    vector<ColonySegment> segments;
+    findSegments(colony, reduction, segments);
+    vector<RoomId> separators;
+    for (size_t i = 1; i < segments.size(); i++) separators.push_back(segments[i].entry);
+
+    // The shortest path is only left at 0 when no ant can reach Sd
+    StepLowerBound bound;
+    computeStepLowerBound(colony, bound);
+    bool reachable = bound.shortestPath > 0;
+    int64_t cutCapacity;
+    vector<RoomId> cut;
+    bool limited = computeMinVertexCut(colony, cutCapacity, cut);
+
+    out << "{\n  \"file\": ";
+    writeJsonString(out, file);
+    out << ",\n  \"ants\": " << colony.numAnts << ",\n  \"rooms\": " << numRooms
+        << ",\n  \"tunnels\": " << colony.tunnels.size() / 2 << ",\n  \"reachable\": " << (reachable ? "true" : "false")
+        << ",\n  \"useful_rooms\": " << reduction.usefulRooms;
+    out << ",\n  \"shortest_path\": ";
+    if (reachable) {
+        out << bound.shortestPath;
+    } else {
+        out << "null";
+    }
+
+    out << ",\n  \"articulation_points\": ";
+    writeRoomNames(out, colony, articulationPoints);
+    out << ",\n  \"biconnected_components\": [";
+    for (size_t b = 0; b < structure.blocks.size(); b++) {
+        out << (b > 0 ? ",\n    " : "\n    ");
+        writeRoomNames(out, colony, structure.blocks[b]);
+    }
+    out << (structure.blocks.empty() ? "]" : "\n  ]");
+
+    out << ",\n  \"separators\": ";
+    writeRoomNames(out, colony, separators);
+    out << ",\n  \"segments\": [";
+    for (size_t i = 0; i < segments.size(); i++) {
+        out << (i > 0 ? ",\n    " : "\n    ") << "{\"entry\": ";
+        writeJsonString(out, colony.roomName(segments[i].entry));
+        out << ", \"exit\": ";
+        writeJsonString(out, colony.roomName(segments[i].exit));
+        out << ", \"rooms\": " << segments[i].rooms.size() << '}';
+    }
+    out << (segments.empty() ? "]" : "\n  ]");
+
+    // Without a cut (Sd next to Sv or out of reach) there is no limit to report
+    out << ",\n  \"min_vertex_cut\": ";
+    if (limited) {
+        out << "{\"capacity\": " << cutCapacity << ", \"rooms\": ";
+        writeRoomNames(out, colony, cut);
+        out << '}';
+    } else {
+        out << "null";
+    }
+    out << ",\n  \"max_ants_per_step\": ";
+    if (limited) {
+        out << cutCapacity;
+    } else {
+        out << "null";
+    }
+    out << ",\n  \"lower_bound\": " << bound.steps << "\n}\n";
+}
+
+int runAnalyze(int argc, char* argv[]) {
+    string outputFile;
+    string file;
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 9, "--output=") == 0) {
+            outputFile = arg.substr(9);
+        } else if (arg.compare(0, 2, "--") == 0 || !file.empty()) {
+            printAnalyzeUsage();
+            return 1;
+        } else {
+            file = arg;
+        }
+    }
+    if (file.empty()) {
+        printAnalyzeUsage();
+        return 1;
+    }
+
+    ColonyInfo colony;
+    if (!loadColonyFromFile(colony, file)) return 1;
+
+    FILE* stream = stdout;
+    if (!outputFile.empty()) {
+        stream = fopen(outputFile.c_str(), "w");
+        if (!stream) {
+            cerr << "Error: unable to write file " << outputFile << endl;
+            return 1;
+        }
+    }
+    {
+        OutputWriter out(stream);
+        writeColonyAnalysis(out, colony, file);
+    }
+    if (stream != stdout) fclose(stream);
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "ants.hpp"
+#include "output.hpp"
+
+// "analyze" subcommand: what limits the throughput of a colony, as a JSON report. It lists the
+// articulation points and biconnected blocks of the whole tunnel graph, the separators every ant
+// goes through and the segments between them (reduction.hpp), and the minimum Sv -> Sd vertex
+// cut weighted by capacity (bounds.hpp), whose capacity is the most ants Sd can take per step.
+void writeColonyAnalysis(OutputWriter& out, const ColonyInfo& colony, const string& file);
+
+int runAnalyze(int argc, char* argv[]);
+
+#endif // ANALYSIS_H
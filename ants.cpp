@@ -1,165 +1,421 @@
 #include "ants.hpp"
+#include "stats.hpp"
+#include "compiled_colony.hpp"
+#include "mapped_file.hpp"
 
-// Global variables
-ColonyInfo colonyInfo;
-map<string, int> roomOccupancy;
+#include <cstring>
 
-// Ant class constructor
-Ant::Ant(string n) {
-    name = n;
-    position = "Sv";
-    finished = false;
+// Every ant starts in Sv
+AntTable::AntTable(int count)
+    : position(max(count, 0), VESTIBULE), active(max(count, 0)), finishedBits((max(count, 0) + 63) / 64, 0),
+      arrival(max(count, 0), 0) {
+    for (int ant = 0; ant < count; ant++) active[ant] = ant;
+}
+
+void AntTable::moveTo(int ant, RoomId room, int64_t step) {
+    position[ant] = room;
+    if (room != DORMITORY) return;
+    finishedBits[ant >> 6] |= uint64_t(1) << (ant & 63);
+    arrival[ant] = step;
+}
+
+void AntTable::compact() {
+    active.erase(remove_if(active.begin(), active.end(), [this](int ant) { return finished(ant); }), active.end());
+}
+
+void ColonyInfo::bindStorage() {
+    nameData = storage->nameData;
+    nameOffsets = storage->nameOffsets;
+    roomCapacity = storage->roomCapacity;
+    roomDeclared = storage->roomDeclared;
+    tunnelOffsets = storage->tunnelOffsets;
+    tunnels = storage->tunnels;
+    dormitoryDistance = storage->dormitoryDistance;
+}
+
+// Register a new room; its name is copied once into the shared name buffer
+RoomId addRoom(ColonyInfo& colony, string_view name) {
+    ColonyStorage& storage = *colony.storage;
+    RoomId id = storage.roomCapacity.size();
+    storage.nameData.insert(storage.nameData.end(), name.begin(), name.end());
+    storage.nameOffsets.push_back(storage.nameData.size());
+    storage.roomCapacity.push_back(1); // Default capacity = 1
+    storage.roomDeclared.push_back(0);
+    return id;
 }
 
 // Add a bidirectional tunnel between two rooms
-void addTunnel(const string& a, const string& b) {
-    colonyInfo.tunnels[a].push_back(b);
-    colonyInfo.tunnels[b].push_back(a);
+void addTunnel(ColonyInfo& colony, RoomId a, RoomId b) {
+    colony.storage->pendingTunnels.push_back({a, b});
 }
 
-// Load colony from file
-bool loadColonyFromFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "Error: unable to open file " << filename << endl;
-        return false;
+// Compile the pending tunnel list into the CSR adjacency
+void buildTunnelGraph(ColonyInfo& colony) {
+    ColonyStorage& storage = *colony.storage;
+    size_t numRooms = storage.roomCapacity.size();
+    vector<uint32_t>& offsets = storage.tunnelOffsets;
+    vector<RoomId>& tunnels = storage.tunnels;
+
+    // Count degrees, then turn them into row offsets
+    offsets.assign(numRooms + 1, 0);
+    for (const auto& tunnel : storage.pendingTunnels) {
+        offsets[tunnel.first + 1]++;
+        offsets[tunnel.second + 1]++;
+    }
+    for (size_t i = 0; i < numRooms; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    // Fill rows in file order so neighbor order matches the tunnel list
+    tunnels.resize(offsets[numRooms]);
+    vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& tunnel : storage.pendingTunnels) {
+        tunnels[fill[tunnel.first]++] = tunnel.second;
+        tunnels[fill[tunnel.second]++] = tunnel.first;
+    }
+
+    // Collapse duplicate tunnels, keeping the first occurrence of each neighbor
+    vector<RoomId> lastSeen(numRooms, NO_ROOM);
+    uint32_t write = 0;
+    for (RoomId room = 0; room < numRooms; room++) {
+        uint32_t begin = offsets[room];
+        uint32_t end = offsets[room + 1];
+        offsets[room] = write;
+        for (uint32_t i = begin; i < end; i++) {
+            RoomId neighbor = tunnels[i];
+            if (lastSeen[neighbor] != room) {
+                lastSeen[neighbor] = room;
+                tunnels[write++] = neighbor;
+            }
+        }
+    }
+    offsets[numRooms] = write;
+    tunnels.resize(write);
+    tunnels.shrink_to_fit();
+
+    vector<pair<RoomId, RoomId>>().swap(storage.pendingTunnels);
+    colony.bindStorage();
+
+    // The distance field depends on the graph only, so it is rebuilt here and nowhere else
+    computeDormitoryDistances(colony);
+}
+
+namespace {
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+string_view trim(string_view text) {
+    while (!text.empty() && isBlank(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isBlank(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+// Same rules as stoi: optional blanks and sign, then at least one digit
+bool parseInteger(string_view text, int& value) {
+    size_t i = 0;
+    while (i < text.size() && isBlank(text[i])) i++;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) negative = text[i++] == '-';
+    if (i == text.size() || text[i] < '0' || text[i] > '9') return false;
+    long long number = 0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9' && number <= INT_MAX) {
+        number = number * 10 + (text[i++] - '0');
+    }
+    if (number > INT_MAX) return false;
+    value = negative ? -number : number;
+    return true;
+}
+
+// Hand-rolled line scanner over the mapped file, lines are views into the mapping
+class LineScanner {
+public:
+    LineScanner(const char* data, size_t size) : cursor(data), end(data + size) {}
+
+    bool next(string_view& line) {
+        if (cursor >= end) return false;
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        const char* lineEnd = newline ? newline : end;
+        line = string_view(cursor, lineEnd - cursor);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        cursor = newline ? newline + 1 : end;
+        return true;
+    }
+
+private:
+    const char* cursor;
+    const char* end;
+};
+
+// Open-addressing table from room name to id. Short names (the usual "S123") are stored
+// inline in the slot, longer ones are compared against the name buffer, so a lookup only
+// hashes a view of the file and never builds a string
+class RoomInterner {
+public:
+    RoomInterner(ColonyInfo& colony) : colony(colony), slots(1024, Slot{0, NO_ROOM, 0}) {
+        intern("Sv");
+        intern("Sd");
+    }
+
+    RoomId intern(string_view name) {
+        uint64_t head = packHead(name);
+        uint32_t hash = hashName(head, name);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.room == NO_ROOM) {
+                RoomId room = addRoom(colony, name);
+                slot = Slot{hash, room, head};
+                if ((room + 1) * 2 > slots.size()) grow();
+                return room;
+            }
+            if (slot.hash == hash && slot.head == head &&
+                (name.size() < sizeof(head) || storedName(slot.room) == name)) {
+                return slot.room;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        RoomId room;
+        uint64_t head; // First 7 bytes of the name and its length (capped at 8)
+    };
+
+    ColonyInfo& colony;
+    vector<Slot> slots; // Power of two size, at most half full
+
+    // Views are not bound while loading, read the name straight from the loader vectors
+    string_view storedName(RoomId room) const {
+        const ColonyStorage& storage = *colony.storage;
+        return string_view(storage.nameData.data() + storage.nameOffsets[room], storage.nameOffsets[room + 1] - storage.nameOffsets[room]);
+    }
+
+    static uint64_t packHead(string_view name) {
+        uint64_t head = min<size_t>(name.size(), sizeof(head));
+        for (size_t i = 0; i < name.size() && i < sizeof(head) - 1; i++) {
+            head |= uint64_t(static_cast<unsigned char>(name[i])) << (8 * (i + 1));
+        }
+        return head;
+    }
+
+    static uint32_t hashName(uint64_t head, string_view name) {
+        uint64_t hash = head * 0x9E3779B97F4A7C15ull;
+        for (size_t i = sizeof(head) - 1; i < name.size(); i++) {
+            hash = (hash ^ static_cast<unsigned char>(name[i])) * 0x100000001B3ull;
+        }
+        return hash >> 32;
+    }
+
+    void grow() {
+        vector<Slot> old(slots.size() * 2, Slot{0, NO_ROOM, 0});
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.room == NO_ROOM) continue;
+            size_t i = slot.hash & mask;
+            while (slots[i].room != NO_ROOM) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
     }
+};
+
+} // namespace
 
-    string line;
+// Read rooms and tunnels from an in-memory copy of the file; the tunnel graph is not built yet
+bool parseColony(ColonyInfo& colony, const char* data, size_t size) {
+    colony = ColonyInfo();
+    colony.sourceBytes = size;
+    colony.storage = make_shared<ColonyStorage>();
+    colony.storage->nameOffsets.push_back(0);
+    RoomInterner rooms(colony);
+    LineScanner scanner(data, size);
+    string_view line;
 
     // Read number of ants
-    if (getline(file, line)) {
-        if (line.substr(0, 2) == "f=") {
-            colonyInfo.numAnts = stoi(line.substr(2));
+    if (scanner.next(line)) {
+        if (line.substr(0, 2) == "f=" && !parseInteger(line.substr(2), colony.numAnts)) {
+            cerr << "Error: invalid number of ants" << endl;
+            return false;
         }
     }
 
-    // Read rooms and their capacities
-    while (getline(file, line)) {
+    // Read rooms and their capacities, up to the first tunnel
+    bool inTunnels = false;
+    while (scanner.next(line)) {
         if (line.empty()) continue;
 
         // If line contains " - ", it's a tunnel
-        if (line.find(" - ") != string::npos) {
-            // Process tunnels later
+        if (line.find(" - ") != string_view::npos) {
+            inTunnels = true;
             break;
         }
 
-        // Process rooms
-        istringstream iss(line); // Enables easy parsing of a line of characters
-        string roomName;
-        iss >> roomName;
+        // Room name is the first word of the line
+        size_t nameStart = 0;
+        while (nameStart < line.size() && isBlank(line[nameStart])) nameStart++;
+        size_t nameEnd = nameStart;
+        while (nameEnd < line.size() && !isBlank(line[nameEnd])) nameEnd++;
+        if (nameStart == nameEnd) continue;
 
-        // Default capacity = 1
+        // Default capacity = 1, or whatever is between { }
         int capacity = 1;
-
-        // Look for capacity between { }
-        size_t start = line.find("{");
-        size_t end = line.find("}");
-        if (start != string::npos && end != string::npos) {
-            string capacityStr = line.substr(start + 1, end - start - 1);
-            capacityStr.erase(0, capacityStr.find_first_not_of(" \t"));
-            capacityStr.erase(capacityStr.find_last_not_of(" \t") + 1);
-            capacity = stoi(capacityStr);
+        size_t start = line.find('{');
+        size_t end = line.find('}');
+        if (start != string_view::npos && end != string_view::npos && start < end) {
+            if (!parseInteger(line.substr(start + 1, end - start - 1), capacity)) {
+                cerr << "Error: invalid capacity in line: " << line << endl;
+                return false;
+            }
         }
 
-        colonyInfo.roomCapacity[roomName] = capacity;
+        RoomId room = rooms.intern(line.substr(nameStart, nameEnd - nameStart));
+        colony.storage->roomCapacity[room] = capacity;
+        colony.storage->roomDeclared[room] = 1;
     }
 
     // Process current line (first tunnel) and following ones
-    do {
-        if (line.empty()) continue;
-
+    while (inTunnels) {
         size_t pos = line.find(" - ");
-        if (pos != string::npos) {
-            string room1 = line.substr(0, pos);
-            string room2 = line.substr(pos + 3);
-
-            // Clean spaces
-            room1.erase(0, room1.find_first_not_of(" \t"));
-            room1.erase(room1.find_last_not_of(" \t") + 1);
-            room2.erase(0, room2.find_first_not_of(" \t"));
-            room2.erase(room2.find_last_not_of(" \t") + 1);
-
-            addTunnel(room1, room2);
+        if (pos != string_view::npos) {
+            RoomId room1 = rooms.intern(trim(line.substr(0, pos)));
+            RoomId room2 = rooms.intern(trim(line.substr(pos + 3)));
+            addTunnel(colony, room1, room2);
         }
-    } while (getline(file, line));
+        inTunnels = scanner.next(line);
+    }
 
-    file.close();
+    return true;
+}
+
+// Load colony from an in-memory copy of the file (the buffer must outlive the call only)
+bool loadColonyFromBuffer(ColonyInfo& colony, const char* data, size_t size) {
+    if (!parseColony(colony, data, size)) return false;
+    buildTunnelGraph(colony);
+    return true;
+}
 
-    // Initialize room occupancy
-    for (const auto& room : colonyInfo.roomCapacity) {
-        roomOccupancy[room.first] = 0;
+// Load colony from file, mapped in memory instead of read line by line.
+// A compiled colony is used in place, a text colony is parsed.
+bool loadColonyFromFile(ColonyInfo& colony, const string& filename) {
+    shared_ptr<MappedFile> file = make_shared<MappedFile>();
+    if (!file->open(filename)) {
+        cerr << "Error: unable to open file " << filename << endl;
+        return false;
     }
 
-    return true;
+    if (isCompiledColony(file->data(), file->size())) {
+        return bindCompiledColony(colony, file);
+    }
+    return loadColonyFromBuffer(colony, file->data(), file->size());
 }
 
 // BFS to find shortest path
-vector<string> findShortestPath(string start, string target) {
+vector<RoomId> findShortestPath(const ColonyInfo& colony, RoomId start, RoomId target) {
     if (start == target) return {start};
+    STAT_INC(STAT_BFS_SEARCHES);
 
-    queue<vector<string>> q;
-    map<string, bool> visited;
+    vector<RoomId> parent(colony.roomCount(), NO_ROOM);
+    queue<RoomId> q;
 
-    q.push({start});
-    visited[start] = true;
+    q.push(start);
+    STAT_INC(STAT_QUEUE_PUSHES);
+    parent[start] = start;
 
     while (!q.empty()) {
-        vector<string> path = q.front();
+        RoomId last = q.front();
         q.pop();
-        string last = path.back();
+        STAT_INC(STAT_NODES_EXPANDED);
+
+        for (RoomId neighbor : colony.neighbors(last)) {
+            if (parent[neighbor] != NO_ROOM) continue;
+            parent[neighbor] = last;
 
-        for (const string& neighbor : colonyInfo.tunnels[last]) {
             if (neighbor == target) {
-                path.push_back(neighbor);
+                // Walk the parents back to the start
+                vector<RoomId> path;
+                for (RoomId room = target; room != start; room = parent[room]) {
+                    path.push_back(room);
+                }
+                path.push_back(start);
+                reverse(path.begin(), path.end());
                 return path;
             }
 
-            if (!visited[neighbor]) {
-                visited[neighbor] = true;
-                vector<string> newPath = path;
-                newPath.push_back(neighbor);
-                q.push(newPath);
-            }
+            q.push(neighbor);
+            STAT_INC(STAT_QUEUE_PUSHES);
         }
     }
 
     return {}; // No path found
 }
 
-// Function to get adjacent rooms
-vector<string> getPossibleNextRooms(string currentPos) {
-    vector<string> nextRooms;
-    // Use the graph to get all adjacent rooms
-    if (colonyInfo.tunnels.find(currentPos) != colonyInfo.tunnels.end()) {
-        nextRooms = colonyInfo.tunnels[currentPos];
+// Single reverse BFS from Sd giving the hop count of every room to the dormitory
+void computeDormitoryDistances(ColonyInfo& colony) {
+    vector<int>& distance = colony.storage->dormitoryDistance;
+    distance.assign(colony.roomCount(), UNREACHABLE);
+
+    vector<RoomId> frontier;
+    frontier.push_back(DORMITORY);
+    distance[DORMITORY] = 0;
+    STAT_INC(STAT_BFS_SEARCHES);
+
+    // Tunnels are bidirectional, so hops from Sd are hops to Sd
+    for (size_t head = 0; head < frontier.size(); head++) {
+        RoomId room = frontier[head];
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (distance[neighbor] == UNREACHABLE) {
+                distance[neighbor] = distance[room] + 1;
+                frontier.push_back(neighbor);
+            }
+        }
+    }
+    STAT_ADD(STAT_NODES_EXPANDED, frontier.size());
+    STAT_ADD(STAT_QUEUE_PUSHES, frontier.size());
+    colony.dormitoryDistance = distance;
+}
+
+// O(1) distance oracle: hops from a room to Sd
+int hopsToDormitory(const ColonyInfo& colony, RoomId room) {
+    return colony.dormitoryDistance[room];
+}
+
+// Sending the ants one by one down the longest shortest path always fits in this many steps
+int64_t simulationStepLimit(const ColonyInfo& colony) {
+    int64_t longest = 0;
+    for (int distance : colony.dormitoryDistance) {
+        if (distance != UNREACHABLE) longest = max<int64_t>(longest, distance);
     }
-    return nextRooms;
+    return max<int64_t>(colony.numAnts, 1) * max<int64_t>(longest, 1);
+}
+
+// Function to get adjacent rooms
+RoomRange getPossibleNextRooms(const ColonyInfo& colony, RoomId currentPos) {
+    return colony.neighbors(currentPos);
 }
 
 // Choose the best next room
-string chooseBestNextRoom(string currentPos, const map<string, int>& tempOccupancy) {
-    vector<string> options = getPossibleNextRooms(currentPos);
+RoomId chooseBestNextRoom(const ColonyInfo& colony, RoomId currentPos, const vector<int>& tempOccupancy) {
+    RoomRange options = getPossibleNextRooms(colony, currentPos);
 
-    if (options.empty()) return "";
+    if (options.empty()) return NO_ROOM;
 
     // If an option is "Sd", prioritize it
-    for (const string& room : options) {
-        if (room == "Sd") return room;
+    for (RoomId room : options) {
+        if (room == DORMITORY) return room;
     }
 
     // Otherwise, choose the room with the shortest path to Sd and available space
-    string bestRoom = "";
-    int shortestDistance = INT_MAX;
-
-    for (const string& room : options) {
-        int currentOccupancy = tempOccupancy.count(room) ? tempOccupancy.at(room) : 0;
-        int capacity = colonyInfo.roomCapacity.count(room) ? colonyInfo.roomCapacity.at(room) : 1;
-
-        if (currentOccupancy < capacity) {
-            vector<string> pathToSd = findShortestPath(room, "Sd");
-            if (!pathToSd.empty() && pathToSd.size() - 1 < shortestDistance) {
-                shortestDistance = pathToSd.size() - 1;
+    RoomId bestRoom = NO_ROOM;
+    int shortestDistance = UNREACHABLE;
+
+    for (RoomId room : options) {
+        if (tempOccupancy[room] < colony.roomCapacity[room]) {
+            int distance = hopsToDormitory(colony, room);
+            if (distance < shortestDistance) {
+                shortestDistance = distance;
                 bestRoom = room;
             }
         }
@@ -169,45 +425,14 @@ string chooseBestNextRoom(string currentPos, const map<string, int>& tempOccupan
 }
 
 // Sort room list by numerical order
-bool compareRooms(const pair<string, int>& a, const pair<string, int>& b) {
-    string roomA = a.first;
-    string roomB = b.first;
-
-    if (roomA[0] == 'S' && roomB[0] == 'S') {
+bool compareRooms(string_view roomA, string_view roomB) {
+    if (!roomA.empty() && !roomB.empty() && roomA[0] == 'S' && roomB[0] == 'S') {
         // Extract numbers and compare
-        int numA = stoi(roomA.substr(1));
-        int numB = stoi(roomB.substr(1));
-        return numA < numB;
+        int numA = 0;
+        int numB = 0;
+        if (parseInteger(roomA.substr(1), numA) && parseInteger(roomB.substr(1), numB)) {
+            return numA < numB;
+        }
     }
     return roomA < roomB;
 }
-
-// Presentation of results
-void printColonyInfo() {
-    cout << "+++ Ant Colony Information +++" << endl;
-
-    cout << "Number of ants: " << colonyInfo.numAnts << endl;
-
-    vector<pair<string, int>> sortedRooms;
-    for (const auto& room : colonyInfo.roomCapacity) {
-        sortedRooms.push_back({room.first, room.second});
-    }
-    sort(sortedRooms.begin(), sortedRooms.end(), compareRooms);
-    cout << "Rooms and capacities:" << endl;
-    for (const auto& room : sortedRooms) {
-        cout << "  " << room.first << " (capacity " << room.second << ")" << endl;
-    }
-
-    cout << "Tunnels:" << endl;
-    map<pair<string, string>, bool> printed;
-    for (const auto& room : colonyInfo.tunnels) {
-        for (const string& neighbor : room.second) {
-            pair<string, string> tunnel = {min(room.first, neighbor), max(room.first, neighbor)};
-            if (!printed[tunnel]) {
-                cout << "  " << room.first << " - " << neighbor << endl;
-                printed[tunnel] = true;
-            }
-        }
-    }
-    cout << endl;
-}
\ No newline at end of file
@@ -3,48 +3,151 @@
 
 #include <iostream>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <climits>
+#include <cstdint>
+#include <memory>
 
 using namespace std;
 
-// Class representing an ant
-class Ant {
-public:
-    string name;
-    string position;
-    bool finished;
+// Dense integer identifier of a room, assigned once when the colony is loaded
+typedef uint32_t RoomId;
 
-    Ant(string n);
+const RoomId NO_ROOM = UINT32_MAX;
+const RoomId VESTIBULE = 0; // Sv is always interned first
+const RoomId DORMITORY = 1; // Sd is always interned second
+const int UNREACHABLE = INT_MAX;
+
+// The ants of a step simulation as parallel arrays indexed by ant (f1 is 0); their names are
+// only made when printing (output.cpp). A step walks active alone, the ants not in Sd yet in
+// index order, so finished ants are compacted out of it once the step is applied.
+struct AntTable {
+    vector<RoomId> position;       // Ant -> room it stands in
+    vector<int> active;            // Ants still on their way, in index order
+    vector<uint64_t> finishedBits; // Ant -> in Sd, one bit each
+    vector<uint32_t> arrival;      // Ant -> step it reached Sd in (0 while on its way)
+
+    explicit AntTable(int count = 0);
+
+    size_t size() const { return position.size(); }
+    bool finished(int ant) const { return (finishedBits[ant >> 6] >> (ant & 63)) & 1; }
+
+    // Move an ant; reaching Sd during step marks it finished, still listed in active until compact
+    void moveTo(int ant, RoomId room, int64_t step);
+
+    // Drop the finished ants from active, keeping the others in index order
+    void compact();
+};
+
+// Contiguous slice of the adjacency array (neighbors of one room)
+struct RoomRange {
+    const RoomId* first;
+    const RoomId* last;
+
+    const RoomId* begin() const { return first; }
+    const RoomId* end() const { return last; }
+    bool empty() const { return first == last; }
+    size_t size() const { return last - first; }
+};
+
+// One ant going through a tunnel during a step
+struct Move {
+    int ant; // Index of the ant (f1 is 0)
+    RoomId from;
+    RoomId to;
+};
+
+// Moves of every step, step 1 first
+typedef vector<vector<Move>> Schedule;
+
+// Read-only window on an array owned elsewhere (loader vectors or a mapped compiled colony)
+template <typename T>
+struct ArrayView {
+    const T* items = nullptr;
+    size_t count = 0;
+
+    ArrayView() {}
+    ArrayView(const T* items, size_t count) : items(items), count(count) {}
+    ArrayView(const vector<T>& values) : items(values.data()), count(values.size()) {}
+
+    const T& operator[](size_t i) const { return items[i]; }
+    const T* data() const { return items; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
 };
 
+// Arrays built by the text loader; a compiled colony has none and points into its mapping instead
+struct ColonyStorage {
+    vector<char> nameData;
+    vector<uint32_t> nameOffsets;
+    vector<int> roomCapacity;
+    vector<char> roomDeclared;
+    vector<uint32_t> tunnelOffsets;
+    vector<RoomId> tunnels;
+    vector<pair<RoomId, RoomId>> pendingTunnels; // Tunnels read from the file, until the graph is built
+    vector<int> dormitoryDistance;
+    shared_ptr<ColonyStorage> shared; // Storage of the colony a pruned colony (reduction.hpp) takes its other arrays from
+};
+
+class MappedFile;
+
 // Structure to store ant colony information
 struct ColonyInfo {
     int numAnts;
-    map<string, int> roomCapacity;
-    map<string, vector<string>> tunnels; // Connection graph
-};
+    size_t sourceBytes;                     // Size of the file the colony was loaded from
+    ArrayView<char> nameData;               // All room names back to back (only needed for printing)
+    ArrayView<uint32_t> nameOffsets;        // Name of r is nameData[nameOffsets[r] .. nameOffsets[r + 1]]
+    ArrayView<int> roomCapacity;            // Room id -> capacity (1 if not declared)
+    ArrayView<char> roomDeclared;           // Room id -> listed in the rooms section
+    ArrayView<uint32_t> tunnelOffsets;      // CSR offsets: neighbors of r are tunnels[offsets[r] .. offsets[r + 1]]
+    ArrayView<RoomId> tunnels;              // CSR neighbor ids, duplicate tunnels collapsed
+    ArrayView<int> dormitoryDistance;       // Room id -> hops to Sd (UNREACHABLE if none), rebuilt with the graph
+
+    // Memory behind the views above
+    shared_ptr<ColonyStorage> storage;
+    shared_ptr<MappedFile> mapping;
+
+    size_t roomCount() const { return roomCapacity.size(); }
 
-// Global variables
-extern ColonyInfo colonyInfo;
-extern map<string, int> roomOccupancy;
+    string_view roomName(RoomId room) const {
+        return string_view(nameData.data() + nameOffsets[room], nameOffsets[room + 1] - nameOffsets[room]);
+    }
+
+    RoomRange neighbors(RoomId room) const {
+        const RoomId* base = tunnels.data();
+        return {base + tunnelOffsets[room], base + tunnelOffsets[room + 1]};
+    }
+
+    // Point every view at the loader vectors
+    void bindStorage();
+};
 
-// Functions for tunnel and colony management
-void addTunnel(const string& a, const string& b);
-bool loadColonyFromFile(const string& filename);
+// Functions for tunnel and colony management (a colony is self-contained, several can be loaded at once)
+RoomId addRoom(ColonyInfo& colony, string_view name);
+void addTunnel(ColonyInfo& colony, RoomId a, RoomId b);
+void buildTunnelGraph(ColonyInfo& colony);
+bool parseColony(ColonyInfo& colony, const char* data, size_t size);
+bool loadColonyFromBuffer(ColonyInfo& colony, const char* data, size_t size);
+bool loadColonyFromFile(ColonyInfo& colony, const string& filename);
 
 // Pathfinding and movement functions
-vector<string> findShortestPath(string start, string target);
-vector<string> getPossibleNextRooms(string currentPos);
-string chooseBestNextRoom(string currentPos, const map<string, int>& tempOccupancy);
+vector<RoomId> findShortestPath(const ColonyInfo& colony, RoomId start, RoomId target);
+void computeDormitoryDistances(ColonyInfo& colony);
+int hopsToDormitory(const ColonyInfo& colony, RoomId room);
+int64_t simulationStepLimit(const ColonyInfo& colony);
+RoomRange getPossibleNextRooms(const ColonyInfo& colony, RoomId currentPos);
+RoomId chooseBestNextRoom(const ColonyInfo& colony, RoomId currentPos, const vector<int>& tempOccupancy);
 
 // Utility functions
-bool compareRooms(const pair<string, int>& a, const pair<string, int>& b);
-void printColonyInfo();
+bool compareRooms(string_view roomA, string_view roomB);
 
-#endif // ANTS_H
\ No newline at end of file
+#endif // ANTS_H
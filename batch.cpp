@@ -0,0 +1,207 @@
+#include "batch.hpp"
+#include "bounds.hpp"
+#include "output.hpp"
+#include "solvers.hpp"
+#include "thread_pool.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+// Colony files of a directory (text or compiled), sorted so runs are reproducible
+bool expandColonyPath(const string& path, vector<string>& files) {
+    namespace fs = std::filesystem;
+    error_code error;
+    if (!fs::is_directory(path, error)) {
+        files.push_back(path);
+        return true;
+    }
+
+    vector<string> found;
+    for (const fs::directory_entry& entry : fs::directory_iterator(path, error)) {
+        string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && (extension == ".txt" || extension == ".uvc")) {
+            found.push_back(entry.path().string());
+        }
+    }
+    if (error) {
+        cerr << "Error: unable to read directory " << path << endl;
+        return false;
+    }
+    sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+    return true;
+}
+
+namespace {
+
+void printBatchUsage() {
+    cerr << "Usage: uneviedefourmi batch [--solver=NAME] [--strategy=NAME] [--threads=N] [--format=csv|json] [--output=FILE]"
+         << " <directory or colony files...>" << endl;
+}
+
+// Quoted only when needed, with embedded quotes doubled
+void writeCsvField(OutputWriter& out, string_view text) {
+    if (text.find_first_of(",\"\n") == string_view::npos) {
+        out << text;
+        return;
+    }
+    out << '"';
+    for (char c : text) {
+        if (c == '"') out << '"';
+        out << c;
+    }
+    out << '"';
+}
+
+void writeCsvSummary(OutputWriter& out, const vector<BatchResult>& results) {
+    out << "file,status,ants,rooms,steps,lower_bound,load_seconds,solve_seconds\n";
+    for (const BatchResult& result : results) {
+        writeCsvField(out, result.file);
+        out << ',' << result.status << ',' << result.numAnts << ',' << result.rooms << ',' << result.steps << ','
+            << result.lowerBound << ',';
+        out.writeFixed(result.loadTime, 6);
+        out << ',';
+        out.writeFixed(result.solveTime, 6);
+        out << '\n';
+    }
+}
+
+void writeJsonSummary(OutputWriter& out, const vector<BatchResult>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BatchResult& result = results[i];
+        out << "  {\"file\": ";
+        writeJsonString(out, result.file);
+        out << ", \"status\": \"" << result.status << "\", \"ants\": " << result.numAnts
+            << ", \"rooms\": " << result.rooms << ", \"steps\": " << result.steps
+            << ", \"lower_bound\": " << result.lowerBound << ", \"load_seconds\": ";
+        out.writeFixed(result.loadTime, 6);
+        out << ", \"solve_seconds\": ";
+        out.writeFixed(result.solveTime, 6);
+        out << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    out << "]\n";
+}
+
+} // namespace
+
+BatchResult solveColonyFile(const string& file, const string& solver, PathStrategy strategy) {
+    BatchResult result;
+    result.file = file;
+
+    // Every job owns its colony, nothing is shared between threads
+    ColonyInfo colony;
+    auto startLoad = chrono::steady_clock::now();
+    if (!loadColonyFromFile(colony, file)) {
+        result.status = "load error";
+        return result;
+    }
+    result.loadTime = chrono::duration<double>(chrono::steady_clock::now() - startLoad).count();
+    result.numAnts = colony.numAnts;
+    result.rooms = colony.roomCount();
+
+    StepLowerBound bound;
+    if (computeStepLowerBound(colony, bound)) result.lowerBound = bound.steps;
+
+    auto startSolve = chrono::steady_clock::now();
+    bool solved;
+    if (solver == "aggregate" || solver == "events") {
+        int64_t moveCount;
+        solved = countAggregateSteps(colony, result.steps, moveCount, solver == "events");
+    } else {
+        Schedule schedule;
+        solved = solveColony(colony, solver, schedule, 0, strategy, result.lowerBound);
+        result.steps = schedule.size();
+    }
+    result.solveTime = chrono::duration<double>(chrono::steady_clock::now() - startSolve).count();
+    if (!solved) result.status = "no path";
+    return result;
+}
+
+int runBatch(int argc, char* argv[]) {
+    string solver = "greedy";
+    PathStrategy strategy = STRATEGY_BFS;
+    string format = "csv";
+    string outputFile;
+    size_t threads = defaultThreadCount();
+    vector<string> files;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 9, "--solver=") == 0) {
+            solver = arg.substr(9);
+        } else if (arg.compare(0, 11, "--strategy=") == 0) {
+            if (!parseStrategy(arg.substr(11), strategy)) {
+                cerr << "Error: unknown strategy " << arg.substr(11) << " (expected bfs, dijkstra, dijkstra-scratch, astar or flow)" << endl;
+                return 1;
+            }
+        } else if (arg.compare(0, 10, "--threads=") == 0) {
+            char* end;
+            long count = strtol(arg.c_str() + 10, &end, 10);
+            if (*end != '\0' || count <= 0) {
+                cerr << "Error: invalid thread count " << arg.substr(10) << endl;
+                return 1;
+            }
+            threads = count;
+        } else if (arg.compare(0, 9, "--format=") == 0) {
+            format = arg.substr(9);
+        } else if (arg.compare(0, 9, "--output=") == 0) {
+            outputFile = arg.substr(9);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            printBatchUsage();
+            return 1;
+        } else if (!expandColonyPath(arg, files)) {
+            return 1;
+        }
+    }
+
+    if (!isKnownSolver(solver)) {
+        cerr << "Error: unknown solver " << solver << " (expected greedy, flow, paths, aggregate or events)" << endl;
+        return 1;
+    }
+    if (format != "csv" && format != "json") {
+        cerr << "Error: unknown summary format " << format << " (expected csv or json)" << endl;
+        return 1;
+    }
+    if (files.empty()) {
+        printBatchUsage();
+        return 1;
+    }
+
+    FILE* stream = stdout;
+    if (!outputFile.empty()) {
+        stream = fopen(outputFile.c_str(), "w");
+        if (!stream) {
+            cerr << "Error: unable to write file " << outputFile << endl;
+            return 1;
+        }
+    }
+
+    // Results land in input order whichever worker solved them
+    auto start = chrono::steady_clock::now();
+    vector<BatchResult> results(files.size());
+    WorkStealingPool pool(min(threads, files.size()));
+    pool.run(files.size(), [&](size_t i) {
+        results[i] = solveColonyFile(files[i], solver, strategy);
+    });
+    double wallTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0;
+    for (const BatchResult& result : results) {
+        if (result.status != "ok") failed++;
+    }
+
+    {
+        OutputWriter out(stream);
+        if (format == "json") {
+            writeJsonSummary(out, results);
+        } else {
+            writeCsvSummary(out, results);
+        }
+    }
+    if (stream != stdout) fclose(stream);
+
+    cerr << "Solved " << results.size() - failed << " of " << results.size() << " colonies on " << pool.size()
+         << " threads in " << wallTime << " seconds" << endl;
+    return failed == 0 ? 0 : 1;
+}
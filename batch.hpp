@@ -0,0 +1,29 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "ants.hpp"
+#include "strategies.hpp"
+
+// Outcome of one colony file in a batch run
+struct BatchResult {
+    string file;
+    string status = "ok"; // "ok", "load error" or "no path"
+    int numAnts = 0;
+    size_t rooms = 0;
+    int64_t steps = 0;
+    int64_t lowerBound = 0; // Fewest steps any solver could take
+    double loadTime = 0;
+    double solveTime = 0;
+};
+
+// Append path to files, or the .txt and .uvc files it contains (sorted) if it is a directory
+bool expandColonyPath(const string& path, vector<string>& files);
+
+// Load and solve one colony file; safe to call from several threads at once
+BatchResult solveColonyFile(const string& file, const string& solver, PathStrategy strategy = STRATEGY_BFS);
+
+// "batch" subcommand: solve every given file (directories are expanded) on a work-stealing pool
+// and write a CSV or JSON summary
+int runBatch(int argc, char* argv[]);
+
+#endif // BATCH_H
@@ -0,0 +1,313 @@
+#include "bounds.hpp"
+
+namespace {
+
+// Hops from one end of the colony to every room, only through rooms an ant can stand in.
+// Ants never come back out of Sd, and coming back through Sv never makes a path shorter.
+void roomDistances(const ColonyInfo& colony, RoomId from, RoomId end, vector<int>& distance) {
+    distance.assign(colony.roomCount(), UNREACHABLE);
+    vector<RoomId> frontier;
+    frontier.push_back(from);
+    distance[from] = 0;
+
+    for (size_t head = 0; head < frontier.size(); head++) {
+        RoomId room = frontier[head];
+        if (room == end) continue;
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (distance[neighbor] != UNREACHABLE) continue;
+            if (neighbor != end && colony.roomCapacity[neighbor] <= 0) continue;
+            distance[neighbor] = distance[room] + 1;
+            frontier.push_back(neighbor);
+        }
+    }
+}
+
+// Minimum Sv -> Sd vertex cut by push-relabel, run on the tunnel graph itself: every room is an
+// in node (2r) and an out node (2r + 1) joined by its capacity, every tunnel an uncapacitated arc
+// from out to in, Sv and Sd unlimited. Instead of building that network, the arcs of a node are
+// read from the CSR: arc 0 joins the two halves of the room, arc k > 0 follows the tunnel to the
+// k-th neighbor (an in node only goes back along tunnels that carry flow into it).
+//
+// Only the first phase runs: it stops once no ant left over can reach Sd any more, which is
+// enough for the value of the flow and the cut. Dinic needs one phase per augmenting path length
+// and grids have thousands of those; heights refreshed by a global BFS from Sd do not care.
+const uint32_t ROOM_ARC = 0;
+const size_t MAX_FLOW_WORK = 64;
+
+class VertexCutFlow {
+public:
+    explicit VertexCutFlow(const ColonyInfo& colony);
+
+    // Maximum flow from Sv to Sd, or limit as soon as the flow gets there. False when the flow
+    // needs more than MAX_FLOW_WORK arc scans per node and arc of the network; usual colonies,
+    // grids included, take less than 20
+    bool run(int64_t limit, int64_t& flow);
+
+    // Rooms of a minimum cut, once run returned less than its limit
+    void cutRooms(vector<RoomId>& rooms) const;
+
+private:
+    const ColonyInfo& colony;
+    uint32_t numNodes;
+    uint32_t source;
+    uint32_t sink;
+    vector<int64_t> roomFlow;   // Flow from the in node to the out node of each room
+    vector<int64_t> tunnelFlow; // CSR arc r -> n: flow from out(r) to in(n)
+    vector<uint32_t> twin;      // CSR arc r -> n -> the arc n -> r
+    vector<int64_t> excess;
+    vector<uint32_t> height;    // numNodes once a node cannot reach Sd any more
+    vector<uint32_t> currentArc;
+    vector<uint32_t> active;    // FIFO of the nodes holding some excess, from activeHead on
+    size_t activeHead;
+
+    uint32_t arcCount(uint32_t node) const {
+        RoomId room = node >> 1;
+        return 1 + colony.tunnelOffsets[room + 1] - colony.tunnelOffsets[room];
+    }
+    int64_t capacity(RoomId room) const {
+        return room == VESTIBULE || room == DORMITORY ? INT64_MAX : max(colony.roomCapacity[room], 0);
+    }
+    uint32_t target(uint32_t node, uint32_t arc) const;
+    uint32_t reverseArc(uint32_t node, uint32_t arc) const;
+    int64_t residual(uint32_t node, uint32_t arc) const;
+    void push(uint32_t node, uint32_t arc, int64_t amount);
+    void activate(uint32_t node);
+    void globalRelabel();
+    void discharge(uint32_t node, size_t& work);
+};
+
+VertexCutFlow::VertexCutFlow(const ColonyInfo& colony)
+    : colony(colony), numNodes(2 * colony.roomCount()), source(2 * VESTIBULE + 1), sink(2 * DORMITORY) {
+    size_t numRooms = colony.roomCount();
+    size_t numArcs = colony.tunnels.size();
+    roomFlow.assign(numRooms, 0);
+    tunnelFlow.assign(numArcs, 0);
+
+    // Tunnels are stored in both directions without duplicates, so the arcs out of a room sorted
+    // by neighbor and the arcs into it sorted by origin pair up one to one
+    vector<uint32_t> incoming(numArcs);
+    vector<uint32_t> fill(colony.tunnelOffsets.begin(), colony.tunnelOffsets.end() - 1);
+    for (RoomId room = 0; room < numRooms; room++) {
+        for (uint32_t i = colony.tunnelOffsets[room]; i < colony.tunnelOffsets[room + 1]; i++) {
+            incoming[fill[colony.tunnels[i]]++] = i;
+        }
+    }
+    vector<uint32_t> outgoing(numArcs);
+    for (uint32_t i = 0; i < numArcs; i++) outgoing[i] = i;
+    twin.assign(numArcs, 0);
+    for (RoomId room = 0; room < numRooms; room++) {
+        auto first = outgoing.begin() + colony.tunnelOffsets[room];
+        auto last = outgoing.begin() + colony.tunnelOffsets[room + 1];
+        sort(first, last, [&](uint32_t a, uint32_t b) { return colony.tunnels[a] < colony.tunnels[b]; });
+        for (uint32_t i = colony.tunnelOffsets[room]; i < colony.tunnelOffsets[room + 1]; i++) {
+            twin[outgoing[i]] = incoming[i];
+        }
+    }
+}
+
+uint32_t VertexCutFlow::target(uint32_t node, uint32_t arc) const {
+    if (arc == ROOM_ARC) return node ^ 1;
+    RoomId neighbor = colony.tunnels[colony.tunnelOffsets[node >> 1] + arc - 1];
+    return (node & 1) ? 2 * neighbor : 2 * neighbor + 1;
+}
+
+// The same arc walked the other way, as an arc of its target
+uint32_t VertexCutFlow::reverseArc(uint32_t node, uint32_t arc) const {
+    if (arc == ROOM_ARC) return ROOM_ARC;
+    uint32_t i = twin[colony.tunnelOffsets[node >> 1] + arc - 1];
+    return 1 + i - colony.tunnelOffsets[target(node, arc) >> 1];
+}
+
+int64_t VertexCutFlow::residual(uint32_t node, uint32_t arc) const {
+    RoomId room = node >> 1;
+    bool out = node & 1;
+    if (arc == ROOM_ARC) return out ? roomFlow[room] : capacity(room) - roomFlow[room];
+
+    uint32_t i = colony.tunnelOffsets[room] + arc - 1;
+    RoomId neighbor = colony.tunnels[i];
+    if (out) {
+        // Ants never walk back into Sv or out of Sd
+        return room == DORMITORY || neighbor == VESTIBULE ? 0 : INT64_MAX;
+    }
+    return tunnelFlow[twin[i]];
+}
+
+void VertexCutFlow::push(uint32_t node, uint32_t arc, int64_t amount) {
+    RoomId room = node >> 1;
+    bool out = node & 1;
+    if (arc == ROOM_ARC) {
+        roomFlow[room] += out ? -amount : amount;
+    } else {
+        uint32_t i = colony.tunnelOffsets[room] + arc - 1;
+        if (out) {
+            tunnelFlow[i] += amount;
+        } else {
+            tunnelFlow[twin[i]] -= amount;
+        }
+    }
+    excess[node] -= amount;
+    excess[target(node, arc)] += amount;
+}
+
+// Called when node just got some excess: nodes already holding some are already queued
+void VertexCutFlow::activate(uint32_t node) {
+    if (node != sink && height[node] < numNodes) active.push_back(node);
+}
+
+// Exact heights: hops to Sd in the residual graph, by a BFS from Sd along arcs walked backward
+void VertexCutFlow::globalRelabel() {
+    height.assign(numNodes, numNodes);
+    vector<uint32_t> frontier;
+    frontier.push_back(sink);
+    height[sink] = 0;
+    for (size_t head = 0; head < frontier.size(); head++) {
+        uint32_t node = frontier[head];
+        for (uint32_t arc = 0; arc < arcCount(node); arc++) {
+            uint32_t from = target(node, arc);
+            if (height[from] == numNodes && from != source && residual(from, reverseArc(node, arc)) > 0) {
+                height[from] = height[node] + 1;
+                frontier.push_back(from);
+            }
+        }
+    }
+
+    active.clear();
+    activeHead = 0;
+    fill(currentArc.begin(), currentArc.end(), 0);
+    for (uint32_t node : frontier) {
+        if (excess[node] > 0) activate(node);
+    }
+}
+
+void VertexCutFlow::discharge(uint32_t node, size_t& work) {
+    while (excess[node] > 0) {
+        uint32_t arcs = arcCount(node);
+        uint32_t& arc = currentArc[node];
+        for (; arc < arcs && excess[node] > 0; arc++) {
+            work++;
+            uint32_t to = target(node, arc);
+            if (height[node] != height[to] + 1) continue;
+            int64_t room = residual(node, arc);
+            if (room <= 0) continue;
+            bool wasIdle = excess[to] == 0;
+            push(node, arc, min(excess[node], room));
+            if (wasIdle) activate(to);
+            if (excess[node] == 0) return; // Keep the arc, it may still have room
+        }
+
+        // Relabel: just above the lowest neighbor still reachable
+        uint32_t lowest = numNodes;
+        for (uint32_t k = 0; k < arcs; k++) {
+            if (residual(node, k) > 0) lowest = min(lowest, height[target(node, k)] + 1);
+        }
+        work += arcs;
+        height[node] = lowest;
+        arc = 0;
+        if (height[node] >= numNodes) return;
+    }
+}
+
+bool VertexCutFlow::run(int64_t limit, int64_t& flow) {
+    flow = limit;
+    excess.assign(numNodes, 0);
+    currentArc.assign(numNodes, 0);
+
+    // Sv stays above everything and sends each neighbor what it can let through; what comes
+    // back to Sv is simply dropped
+    for (uint32_t arc = 1; arc < arcCount(source); arc++) {
+        RoomId neighbor = target(source, arc) >> 1;
+        if (neighbor == DORMITORY) return true;
+        if (residual(source, arc) > 0 && capacity(neighbor) > 0) push(source, arc, capacity(neighbor));
+    }
+    globalRelabel();
+
+    // Heights drift away from the real distances as nodes get relabeled one by one, so they are
+    // recomputed every so often
+    size_t relabelPeriod = numNodes + colony.tunnels.size();
+    size_t budget = MAX_FLOW_WORK * relabelPeriod;
+    size_t work = 0;
+    while (activeHead < active.size()) {
+        discharge(active[activeHead++], work);
+        if (excess[sink] >= limit) return true;
+        if (work > relabelPeriod) {
+            if (budget < work) return false;
+            budget -= work;
+            globalRelabel();
+            work = 0;
+        }
+    }
+
+    // Heights below numNodes are only lower bounds on the hops left; the cut needs the real ones
+    globalRelabel();
+    flow = excess[sink];
+    return true;
+}
+
+// The sink side of the cut is what can still reach Sd: a room is cut when its in node cannot
+// and its out node can
+void VertexCutFlow::cutRooms(vector<RoomId>& rooms) const {
+    rooms.clear();
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (height[2 * room] >= numNodes && height[2 * room + 1] < numNodes) rooms.push_back(room);
+    }
+}
+
+// Bound given by a vertex cut: its rooms can be reached toCut steps after the start at the
+// earliest, hold throughput ants at a time and are still fromCut steps away from Sd
+int64_t cutBound(int64_t numAnts, int64_t throughput, int toCut, int fromCut) {
+    return toCut + (numAnts + throughput - 1) / throughput - 1 + fromCut;
+}
+
+} // namespace
+
+bool computeStepLowerBound(const ColonyInfo& colony, StepLowerBound& bound) {
+    bound = StepLowerBound();
+    int64_t numAnts = colony.numAnts;
+
+    vector<int> fromVestibule;
+    roomDistances(colony, VESTIBULE, DORMITORY, fromVestibule);
+    if (fromVestibule[DORMITORY] == UNREACHABLE) return numAnts <= 0;
+    bound.shortestPath = fromVestibule[DORMITORY];
+    if (numAnts <= 0) return true;
+    bound.steps = bound.shortestPath;
+
+    // Past numAnts the cut no longer slows anyone down, so the flow can stop there. When the
+    // flow takes too long, the shortest path is all the bound says.
+    VertexCutFlow flow(colony);
+    if (!flow.run(numAnts, bound.throughput)) {
+        bound.throughput = 0;
+        return true;
+    }
+    if (bound.throughput >= numAnts) return true;
+
+    vector<int> toDormitory;
+    roomDistances(colony, DORMITORY, VESTIBULE, toDormitory);
+    vector<RoomId> cut;
+    flow.cutRooms(cut);
+    bound.toCut = UNREACHABLE;
+    bound.fromCut = UNREACHABLE;
+    for (RoomId room : cut) {
+        bound.toCut = min(bound.toCut, fromVestibule[room]);
+        bound.fromCut = min(bound.fromCut, toDormitory[room]);
+    }
+    bound.steps = max(bound.steps, cutBound(numAnts, bound.throughput, bound.toCut, bound.fromCut));
+    return true;
+}
+
+bool computeMinVertexCut(const ColonyInfo& colony, int64_t& capacity, vector<RoomId>& rooms) {
+    capacity = 0;
+    rooms.clear();
+
+    // All the rooms together are a cut, so a flow reaching their capacity went straight to Sd
+    int64_t limit = 1;
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (room != VESTIBULE && room != DORMITORY) limit += max(colony.roomCapacity[room], 0);
+    }
+    VertexCutFlow flow(colony);
+    if (!flow.run(limit, capacity) || capacity <= 0 || capacity >= limit) {
+        capacity = 0;
+        return false;
+    }
+    flow.cutRooms(rooms);
+    return true;
+}
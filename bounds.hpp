@@ -0,0 +1,28 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "ants.hpp"
+
+// Fewest steps any schedule can take, whatever the solver. Every ant has to stand in one of
+// the rooms of a minimum Sv -> Sd vertex cut at the end of some step; these rooms hold at most
+// throughput ants together, can only be reached toCut steps after the start and still need
+// fromCut steps to Sd. So steps >= toCut + ceil(ants / throughput) - 1 + fromCut, and never
+// fewer than the shortest path.
+struct StepLowerBound {
+    int64_t steps = 0;
+    int shortestPath = 0;   // Hops from Sv to Sd through rooms with some capacity
+    int64_t throughput = 0; // Capacity of the minimum vertex cut, at most the number of ants
+                            // (0 when the flow was given up on, see bounds.cpp)
+    int toCut = 0;          // Fewest hops from Sv to a room of the cut
+    int fromCut = 0;        // Fewest hops from a room of the cut to Sd
+};
+
+// False when no ant can reach Sd (bound.steps is 0 when there are no ants)
+bool computeStepLowerBound(const ColonyInfo& colony, StepLowerBound& bound);
+
+// Minimum Sv -> Sd vertex cut weighted by room capacity, whatever the number of ants: its rooms
+// and capacity, the most ants that can reach Sd per step. False when no ant can reach Sd, when
+// Sd is next to Sv (nothing to cut) or when the flow was given up on.
+bool computeMinVertexCut(const ColonyInfo& colony, int64_t& capacity, vector<RoomId>& rooms);
+
+#endif // BOUNDS_H
@@ -0,0 +1,159 @@
+#include "compiled_colony.hpp"
+#include "mapped_file.hpp"
+
+#include <cstring>
+
+namespace {
+
+const char COMPILED_MAGIC[8] = {'U', 'V', 'D', 'F', 'C', 'O', 'L', '\0'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+uint64_t alignSection(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+// A section is usable if it lies inside the file and is aligned for its element type
+template <typename T>
+bool sectionFits(uint64_t at, uint64_t count, size_t fileSize) {
+    if (at % alignof(T) != 0 || at > fileSize) return false;
+    return count <= (fileSize - at) / sizeof(T);
+}
+
+template <typename T>
+ArrayView<T> sectionView(const char* base, uint64_t at, uint64_t count) {
+    return ArrayView<T>(reinterpret_cast<const T*>(base + at), count);
+}
+
+// Offsets into an array of total entries: starting at 0, never decreasing, ending at total
+bool offsetsValid(const ArrayView<uint32_t>& offsets, uint64_t total) {
+    if (offsets[0] != 0 || offsets[offsets.size() - 1] != total) return false;
+    for (size_t i = 1; i < offsets.size(); i++) {
+        if (offsets[i] < offsets[i - 1]) return false;
+    }
+    return true;
+}
+
+// One linear pass over the sections the planners index with: after it, no row, tunnel or
+// distance read from the file can point outside the colony
+bool sectionsValid(const ColonyInfo& colony, const CompiledColonyHeader& header) {
+    uint64_t rooms = header.roomCount;
+    if (!offsetsValid(colony.nameOffsets, header.nameBytes) || !offsetsValid(colony.tunnelOffsets, header.tunnelCount)) {
+        return false;
+    }
+    for (RoomId neighbor : colony.tunnels) {
+        if (neighbor >= rooms) return false;
+    }
+    for (int distance : colony.dormitoryDistance) {
+        if (distance != UNREACHABLE && (distance < 0 || uint64_t(distance) > rooms)) return false;
+    }
+    return true;
+}
+
+template <typename T>
+void writeSection(ofstream& out, uint64_t& position, uint64_t at, const T* data, uint64_t count) {
+    static const char padding[8] = {0};
+    out.write(padding, at - position);
+    out.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+    position = at + count * sizeof(T);
+}
+
+} // namespace
+
+bool isCompiledColony(const char* data, size_t size) {
+    return size >= sizeof(COMPILED_MAGIC) && memcmp(data, COMPILED_MAGIC, sizeof(COMPILED_MAGIC)) == 0;
+}
+
+bool bindCompiledColony(ColonyInfo& colony, shared_ptr<MappedFile> mapping) {
+    const char* base = mapping->data();
+    size_t size = mapping->size();
+
+    CompiledColonyHeader header;
+    if (!isCompiledColony(base, size) || size < sizeof(header)) {
+        cerr << "Error: compiled colony is truncated or corrupted" << endl;
+        return false;
+    }
+    memcpy(&header, base, sizeof(header));
+    if (header.version != COMPILED_COLONY_VERSION) {
+        cerr << "Error: compiled colony version " << header.version << " is not supported" << endl;
+        return false;
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+        cerr << "Error: compiled colony was written on a machine with another byte order" << endl;
+        return false;
+    }
+
+    uint64_t rooms = header.roomCount;
+    if (rooms < 2 || rooms >= NO_ROOM ||
+        !sectionFits<uint32_t>(header.nameOffsetsAt, rooms + 1, size) ||
+        !sectionFits<char>(header.nameDataAt, header.nameBytes, size) ||
+        !sectionFits<int>(header.capacityAt, rooms, size) ||
+        !sectionFits<char>(header.declaredAt, rooms, size) ||
+        !sectionFits<uint32_t>(header.tunnelOffsetsAt, rooms + 1, size) ||
+        !sectionFits<RoomId>(header.tunnelsAt, header.tunnelCount, size) ||
+        !sectionFits<int>(header.distanceAt, rooms, size)) {
+        cerr << "Error: compiled colony is truncated or corrupted" << endl;
+        return false;
+    }
+
+    colony = ColonyInfo();
+    colony.numAnts = header.numAnts;
+    colony.sourceBytes = size;
+    colony.nameOffsets = sectionView<uint32_t>(base, header.nameOffsetsAt, rooms + 1);
+    colony.nameData = sectionView<char>(base, header.nameDataAt, header.nameBytes);
+    colony.roomCapacity = sectionView<int>(base, header.capacityAt, rooms);
+    colony.roomDeclared = sectionView<char>(base, header.declaredAt, rooms);
+    colony.tunnelOffsets = sectionView<uint32_t>(base, header.tunnelOffsetsAt, rooms + 1);
+    colony.tunnels = sectionView<RoomId>(base, header.tunnelsAt, header.tunnelCount);
+    colony.dormitoryDistance = sectionView<int>(base, header.distanceAt, rooms);
+    colony.mapping = mapping;
+
+    if (!sectionsValid(colony, header)) {
+        colony = ColonyInfo();
+        cerr << "Error: compiled colony is truncated or corrupted" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeCompiledColony(const ColonyInfo& colony, const string& filename) {
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Error: unable to write file " << filename << endl;
+        return false;
+    }
+
+    uint64_t rooms = colony.roomCount();
+    CompiledColonyHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+    header.version = COMPILED_COLONY_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.numAnts = colony.numAnts;
+    header.roomCount = rooms;
+    header.tunnelCount = colony.tunnels.size();
+    header.nameBytes = colony.nameData.size();
+    header.nameOffsetsAt = alignSection(sizeof(header));
+    header.nameDataAt = alignSection(header.nameOffsetsAt + (rooms + 1) * sizeof(uint32_t));
+    header.capacityAt = alignSection(header.nameDataAt + header.nameBytes);
+    header.declaredAt = alignSection(header.capacityAt + rooms * sizeof(int));
+    header.tunnelOffsetsAt = alignSection(header.declaredAt + rooms);
+    header.tunnelsAt = alignSection(header.tunnelOffsetsAt + (rooms + 1) * sizeof(uint32_t));
+    header.distanceAt = alignSection(header.tunnelsAt + header.tunnelCount * sizeof(RoomId));
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+    writeSection(out, position, header.nameOffsetsAt, colony.nameOffsets.data(), rooms + 1);
+    writeSection(out, position, header.nameDataAt, colony.nameData.data(), header.nameBytes);
+    writeSection(out, position, header.capacityAt, colony.roomCapacity.data(), rooms);
+    writeSection(out, position, header.declaredAt, colony.roomDeclared.data(), rooms);
+    writeSection(out, position, header.tunnelOffsetsAt, colony.tunnelOffsets.data(), rooms + 1);
+    writeSection(out, position, header.tunnelsAt, colony.tunnels.data(), header.tunnelCount);
+    writeSection(out, position, header.distanceAt, colony.dormitoryDistance.data(), rooms);
+
+    out.close();
+    if (!out) {
+        cerr << "Error: failed while writing " << filename << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef COMPILED_COLONY_H
+#define COMPILED_COLONY_H
+
+#include "ants.hpp"
+
+// Binary snapshot of a loaded colony: interned names, capacities, CSR adjacency and Sd distances,
+// each section 8-byte aligned so a mapped file can be used in place without any decoding
+struct CompiledColonyHeader {
+    char magic[8];           // "UVDFCOL" + NUL
+    uint32_t version;
+    uint32_t byteOrder;      // 0x01020304 as written by the compiling machine
+    int64_t numAnts;
+    uint64_t roomCount;
+    uint64_t tunnelCount;    // CSR entries (each tunnel appears twice)
+    uint64_t nameBytes;
+    uint64_t nameOffsetsAt;  // uint32_t[roomCount + 1]
+    uint64_t nameDataAt;     // char[nameBytes]
+    uint64_t capacityAt;     // int32_t[roomCount]
+    uint64_t declaredAt;     // char[roomCount]
+    uint64_t tunnelOffsetsAt; // uint32_t[roomCount + 1]
+    uint64_t tunnelsAt;      // uint32_t[tunnelCount]
+    uint64_t distanceAt;     // int32_t[roomCount]
+};
+
+const uint32_t COMPILED_COLONY_VERSION = 1;
+
+bool isCompiledColony(const char* data, size_t size);
+
+// Point a colony at the sections of a mapped compiled colony (the mapping is kept alive by it)
+bool bindCompiledColony(ColonyInfo& colony, shared_ptr<MappedFile> mapping);
+
+// Write a loaded colony as a compiled colony
+bool writeCompiledColony(const ColonyInfo& colony, const string& filename);
+
+#endif // COMPILED_COLONY_H
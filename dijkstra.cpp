@@ -0,0 +1,270 @@
+#include "dijkstra.hpp"
+#include "stats.hpp"
+
+// Calculate edge weight based on congestion
+int congestionWeight(const ColonyInfo& colony, RoomId room, const vector<int>& tempOccupancy) {
+    if (room == VESTIBULE || room == DORMITORY) return 1;
+    int occupancy = tempOccupancy[room];
+    int capacity = colony.roomCapacity[room];
+
+    // Penalize congested rooms
+    if (occupancy >= capacity) {
+        return MAX_CONGESTION_WEIGHT; // High penalty for full rooms
+    } else if (occupancy > capacity * 0.7) {
+        return 5; // Medium penalty for crowded rooms
+    }
+    return 1;
+}
+
+CongestionSearch::CongestionSearch(const ColonyInfo& colony)
+    : colony(colony), buckets(MAX_CONGESTION_WEIGHT + 1) {
+    size_t numRooms = colony.roomCount();
+    stamp.assign(numRooms, 0);
+    distance.assign(numRooms, 0);
+    hops.assign(numRooms, 0);
+    parent.assign(numRooms, NO_ROOM);
+    first.assign(numRooms, NO_ROOM);
+
+    // Only declared rooms and Sd can be entered, never Sv
+    enterable.assign(numRooms, 0);
+    for (RoomId room = 0; room < numRooms; room++) {
+        enterable[room] = room == DORMITORY || (room != VESTIBULE && colony.roomDeclared[room]);
+    }
+}
+
+// Dial's algorithm: tentative distances live in a ring of MAX_CONGESTION_WEIGHT + 1 buckets,
+// enough since no tunnel reaches further than that past the distance being settled
+bool CongestionSearch::run(RoomId start, RoomId target, const vector<int>& tempOccupancy) {
+    // A new generation invalidates every distance of the previous search at once
+    if (++generation == 0) {
+        fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    searchStart = start;
+    searchTarget = target;
+    stamp[start] = generation;
+    distance[start] = 0;
+    hops[start] = 0;
+    parent[start] = start;
+    first[start] = NO_ROOM;
+    if (start == target) return true;
+    STAT_INC(STAT_DIJKSTRA_SEARCHES);
+
+    for (vector<RoomId>& bucket : buckets) bucket.clear();
+    buckets[0].push_back(start);
+    STAT_INC(STAT_QUEUE_PUSHES);
+    size_t queued = 1;
+
+    for (int current = 0; queued > 0; current++) {
+        vector<RoomId>& bucket = buckets[current % buckets.size()];
+        // Weights are at least 1, so nothing is added to this bucket while it is scanned
+        for (size_t i = 0; i < bucket.size(); i++) {
+            RoomId room = bucket[i];
+            queued--;
+            if (distance[room] != current) continue; // Reached again more cheaply since
+            STAT_INC(STAT_NODES_EXPANDED);
+
+            if (room == target) {
+                for (vector<RoomId>& rest : buckets) rest.clear();
+                return true;
+            }
+
+            for (RoomId neighbor : colony.neighbors(room)) {
+                if (!enterable[neighbor] || neighbor == start) continue;
+                int newDistance = current + congestionWeight(colony, neighbor, tempOccupancy);
+                int newHops = hops[room] + 1;
+                RoomId newFirst = room == start ? neighbor : first[room];
+                if (stamp[neighbor] != generation || newDistance < distance[neighbor]) {
+                    stamp[neighbor] = generation;
+                    distance[neighbor] = newDistance;
+                    hops[neighbor] = newHops;
+                    parent[neighbor] = room;
+                    first[neighbor] = newFirst;
+                    buckets[newDistance % buckets.size()].push_back(neighbor);
+                    queued++;
+                    STAT_INC(STAT_QUEUE_PUSHES);
+                } else if (newDistance == distance[neighbor] &&
+                           (newHops < hops[neighbor] || (newHops == hops[neighbor] && newFirst < first[neighbor]))) {
+                    // Same cost: already queued in this bucket, and not expanded yet since every
+                    // tunnel costs at least 1
+                    hops[neighbor] = newHops;
+                    parent[neighbor] = room;
+                    first[neighbor] = newFirst;
+                }
+            }
+        }
+        bucket.clear();
+    }
+
+    return false; // No path found
+}
+
+int CongestionSearch::pathRooms() const {
+    return hops[searchTarget] + 1;
+}
+
+int CongestionSearch::pathCost() const {
+    return distance[searchTarget];
+}
+
+RoomId CongestionSearch::firstStep() const {
+    return first[searchTarget];
+}
+
+void CongestionSearch::path(vector<RoomId>& rooms) const {
+    rooms.clear();
+    for (RoomId room = searchTarget; room != searchStart; room = parent[room]) {
+        rooms.push_back(room);
+    }
+    rooms.push_back(searchStart);
+    reverse(rooms.begin(), rooms.end());
+}
+
+// Dijkstra's algorithm to find shortest path with congestion awareness
+vector<RoomId> findShortestPathDijkstra(const ColonyInfo& colony, RoomId start, RoomId target, const vector<int>& tempOccupancy) {
+    CongestionSearch search(colony);
+    vector<RoomId> rooms;
+    if (search.run(start, target, tempOccupancy)) search.path(rooms);
+    return rooms;
+}
+
+// Choose the best next room using Dijkstra
+RoomId chooseBestNextRoomDijkstra(const ColonyInfo& colony, CongestionSearch& search, RoomId currentPos, const vector<int>& tempOccupancy) {
+    RoomRange options = getPossibleNextRooms(colony, currentPos);
+
+    if (options.empty()) return NO_ROOM;
+
+    // If an option is "Sd", prioritize it
+    for (RoomId room : options) {
+        if (room == DORMITORY) return room;
+    }
+
+    // Use Dijkstra to find the best path considering congestion
+    if (search.run(currentPos, DORMITORY, tempOccupancy)) {
+        RoomId nextRoom = search.firstStep(); // Next room in the optimal path
+
+        // Verify the room has space
+        if (nextRoom != NO_ROOM && tempOccupancy[nextRoom] < colony.roomCapacity[nextRoom]) {
+            return nextRoom;
+        }
+    }
+
+    // Fallback: choose any available adjacent room
+    for (RoomId room : options) {
+        if (tempOccupancy[room] < colony.roomCapacity[room]) {
+            return room;
+        }
+    }
+
+    return NO_ROOM;
+}
+
+AStarSearch::AStarSearch(const ColonyInfo& colony) : colony(colony) {
+    size_t numRooms = colony.roomCount();
+    stamp.assign(numRooms, 0);
+    cost.assign(numRooms, 0);
+    parent.assign(numRooms, NO_ROOM);
+}
+
+// A* with the same weights: every tunnel costs at least 1, so the hop count to Sd never
+// overestimates and the search only expands rooms that can still be on a cheapest path
+bool AStarSearch::run(RoomId start, const vector<int>& tempOccupancy) {
+    searchStart = start;
+    if (start == DORMITORY) return true;
+    if (hopsToDormitory(colony, start) == UNREACHABLE) return false;
+    STAT_INC(STAT_ASTAR_SEARCHES);
+
+    if (++generation == 0) {
+        fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    greater<pair<int, RoomId>> later;
+    open.clear(); // Binary heap of (cost + hops, room), earliest on top
+    stamp[start] = generation;
+    cost[start] = 0;
+    parent[start] = start;
+    open.push_back({hopsToDormitory(colony, start), start});
+    STAT_INC(STAT_QUEUE_PUSHES);
+
+    while (!open.empty()) {
+        pop_heap(open.begin(), open.end(), later);
+        pair<int, RoomId> top = open.back();
+        open.pop_back();
+        RoomId room = top.second;
+        if (top.first - hopsToDormitory(colony, room) > costOf(room)) continue; // Stale entry
+        STAT_INC(STAT_NODES_EXPANDED);
+
+        if (room == DORMITORY) return true;
+
+        for (RoomId neighbor : colony.neighbors(room)) {
+            int hops = hopsToDormitory(colony, neighbor);
+            if (hops == UNREACHABLE) continue;
+            int newCost = cost[room] + congestionWeight(colony, neighbor, tempOccupancy);
+            if (newCost < costOf(neighbor)) {
+                stamp[neighbor] = generation;
+                cost[neighbor] = newCost;
+                parent[neighbor] = room;
+                open.push_back({newCost + hops, neighbor});
+                push_heap(open.begin(), open.end(), later);
+                STAT_INC(STAT_QUEUE_PUSHES);
+            }
+        }
+    }
+
+    return false; // No path found
+}
+
+int AStarSearch::pathRooms() const {
+    int rooms = 1;
+    for (RoomId room = DORMITORY; room != searchStart; room = parent[room]) rooms++;
+    return rooms;
+}
+
+RoomId AStarSearch::firstStep() const {
+    if (searchStart == DORMITORY) return NO_ROOM;
+    RoomId room = DORMITORY;
+    while (parent[room] != searchStart) room = parent[room];
+    return room;
+}
+
+void AStarSearch::path(vector<RoomId>& rooms) const {
+    rooms.clear();
+    for (RoomId room = DORMITORY; room != searchStart; room = parent[room]) {
+        rooms.push_back(room);
+    }
+    rooms.push_back(searchStart);
+    reverse(rooms.begin(), rooms.end());
+}
+
+vector<RoomId> findPathToDormitoryAStar(const ColonyInfo& colony, RoomId start, const vector<int>& tempOccupancy) {
+    AStarSearch search(colony);
+    vector<RoomId> rooms;
+    if (search.run(start, tempOccupancy)) search.path(rooms);
+    return rooms;
+}
+
+// Same rule as chooseBestNextRoomDijkstra, with the A* path
+RoomId chooseBestNextRoomAStar(const ColonyInfo& colony, AStarSearch& search, RoomId currentPos, const vector<int>& tempOccupancy) {
+    RoomRange options = getPossibleNextRooms(colony, currentPos);
+
+    if (options.empty()) return NO_ROOM;
+
+    for (RoomId room : options) {
+        if (room == DORMITORY) return room;
+    }
+
+    if (search.run(currentPos, tempOccupancy)) {
+        RoomId nextRoom = search.firstStep();
+        if (nextRoom != NO_ROOM && tempOccupancy[nextRoom] < colony.roomCapacity[nextRoom]) {
+            return nextRoom;
+        }
+    }
+
+    for (RoomId room : options) {
+        if (tempOccupancy[room] < colony.roomCapacity[room]) {
+            return room;
+        }
+    }
+
+    return NO_ROOM;
+}
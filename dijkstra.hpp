@@ -0,0 +1,80 @@
+#ifndef DIJKSTRA_H
+#define DIJKSTRA_H
+
+#include "ants.hpp"
+
+const int MAX_CONGESTION_WEIGHT = 100;
+
+// Cost of entering a room: 1, 5 above 70% of capacity, 100 when full (always 1 for Sv and Sd)
+int congestionWeight(const ColonyInfo& colony, RoomId room, const vector<int>& tempOccupancy);
+
+// Shortest path where tunnels into crowded rooms cost more, through declared rooms only.
+// Among equally cheap paths the one with the fewest rooms wins, then the one whose first room
+// has the smallest id, whatever order the rooms come out of the queue in (the same rule as
+// IncrementalCongestionPaths, so both find the same path).
+// Weights are small integers, so the search uses a bucket queue instead of a heap. All its
+// arrays are sized once for the colony and reused: a search allocates nothing once the
+// buckets have grown, and the path is only rebuilt from the predecessors when asked for.
+class CongestionSearch {
+public:
+    explicit CongestionSearch(const ColonyInfo& colony);
+
+    // False when target cannot be reached from start
+    bool run(RoomId start, RoomId target, const vector<int>& tempOccupancy);
+
+    // Results of the last successful run
+    int pathRooms() const;   // Rooms on the path, start and target included
+    int pathCost() const;
+    RoomId firstStep() const; // Room after start (NO_ROOM if start is the target)
+    void path(vector<RoomId>& rooms) const;
+
+private:
+    const ColonyInfo& colony;
+    vector<char> enterable;
+    vector<uint32_t> stamp; // distance, hops, parent and first of r are valid when stamp[r] == generation
+    uint32_t generation = 0;
+    vector<int> distance;
+    vector<int> hops;
+    vector<RoomId> parent;
+    vector<RoomId> first;   // Room after start on the path to r
+    vector<vector<RoomId>> buckets; // Ring indexed by distance modulo its size
+    RoomId searchStart = NO_ROOM;
+    RoomId searchTarget = NO_ROOM;
+};
+
+// One-off search returning the whole path (empty if none); loops should keep a CongestionSearch
+vector<RoomId> findShortestPathDijkstra(const ColonyInfo& colony, RoomId start, RoomId target, const vector<int>& tempOccupancy);
+
+// Next room following the congestion-aware path, or the first free neighbor if that room is full
+RoomId chooseBestNextRoomDijkstra(const ColonyInfo& colony, CongestionSearch& search, RoomId currentPos, const vector<int>& tempOccupancy);
+
+// Same congestion weights searched with A* toward Sd, guided by the hop distance to Sd (no path
+// through unreachable rooms). Like CongestionSearch, its arrays and heap are reused between runs.
+class AStarSearch {
+public:
+    explicit AStarSearch(const ColonyInfo& colony);
+
+    // False when Sd cannot be reached from start
+    bool run(RoomId start, const vector<int>& tempOccupancy);
+
+    // Results of the last successful run
+    int pathRooms() const;
+    RoomId firstStep() const;
+    void path(vector<RoomId>& rooms) const;
+
+private:
+    const ColonyInfo& colony;
+    vector<uint32_t> stamp; // cost and parent of r are valid when stamp[r] == generation
+    uint32_t generation = 0;
+    vector<int> cost;
+    vector<RoomId> parent;
+    vector<pair<int, RoomId>> open;
+    RoomId searchStart = NO_ROOM;
+
+    int costOf(RoomId room) const { return stamp[room] == generation ? cost[room] : INT_MAX; }
+};
+
+vector<RoomId> findPathToDormitoryAStar(const ColonyInfo& colony, RoomId start, const vector<int>& tempOccupancy);
+RoomId chooseBestNextRoomAStar(const ColonyInfo& colony, AStarSearch& search, RoomId currentPos, const vector<int>& tempOccupancy);
+
+#endif // DIJKSTRA_H
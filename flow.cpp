@@ -0,0 +1,355 @@
+#include "flow.hpp"
+#include "stats.hpp"
+
+#include <deque>
+
+int MaxFlow::addNode() {
+    graph.emplace_back();
+    return graph.size() - 1;
+}
+
+int MaxFlow::addEdge(int from, int to, int64_t capacity) {
+    int id = edges.size();
+    edges.push_back({to, capacity});
+    edges.push_back({from, 0});
+    graph[from].push_back(id);
+    graph[to].push_back(id + 1);
+    return id;
+}
+
+// Flow on a forward edge is the residual capacity of its reverse edge
+int64_t MaxFlow::flowOn(int edge) const {
+    return edges[edge ^ 1].residual;
+}
+
+// BFS levels on the residual graph, false once the sink is cut off
+bool MaxFlow::buildLevels(int source, int sink) {
+    level.assign(graph.size(), -1);
+    vector<int> frontier;
+    frontier.push_back(source);
+    level[source] = 0;
+
+    for (size_t head = 0; head < frontier.size(); head++) {
+        int node = frontier[head];
+        for (int e : graph[node]) {
+            int to = edges[e].to;
+            if (edges[e].residual > 0 && level[to] < 0) {
+                level[to] = level[node] + 1;
+                frontier.push_back(to);
+            }
+        }
+    }
+    STAT_INC(STAT_BFS_SEARCHES);
+    STAT_ADD(STAT_NODES_EXPANDED, frontier.size());
+    STAT_ADD(STAT_QUEUE_PUSHES, frontier.size());
+    return level[sink] >= 0;
+}
+
+// Iterative DFS so long paths (big colonies, long horizons) cannot overflow the stack
+int64_t MaxFlow::blockingFlow(int source, int sink, int64_t limit) {
+    int64_t total = 0;
+
+    while (total < limit) {
+        path.clear();
+        int node = source;
+
+        while (node != sink) {
+            bool advanced = false;
+            for (; nextEdge[node] < graph[node].size(); nextEdge[node]++) {
+                int e = graph[node][nextEdge[node]];
+                int to = edges[e].to;
+                if (edges[e].residual > 0 && level[to] == level[node] + 1) {
+                    path.push_back(e);
+                    node = to;
+                    advanced = true;
+                    break;
+                }
+            }
+            if (advanced) continue;
+
+            // Dead end: never come back here during this phase
+            if (node == source) return total;
+            level[node] = -1;
+            int e = path.back();
+            path.pop_back();
+            node = edges[e ^ 1].to;
+            nextEdge[node]++;
+        }
+
+        int64_t pushed = limit - total;
+        for (int e : path) {
+            pushed = min(pushed, edges[e].residual);
+        }
+        for (int e : path) {
+            edges[e].residual -= pushed;
+            edges[e ^ 1].residual += pushed;
+        }
+        total += pushed;
+    }
+
+    return total;
+}
+
+int64_t MaxFlow::augment(int source, int sink, int64_t limit) {
+    int64_t total = 0;
+    while (total < limit && buildLevels(source, sink)) {
+        nextEdge.assign(graph.size(), 0);
+        total += blockingFlow(source, sink, limit - total);
+    }
+    return total;
+}
+
+int MinCostFlow::addNode() {
+    graph.emplace_back();
+    potential.push_back(0);
+    return graph.size() - 1;
+}
+
+int MinCostFlow::addEdge(int from, int to, int64_t capacity, int64_t cost) {
+    int id = edges.size();
+    edges.push_back({to, capacity, cost});
+    edges.push_back({from, 0, -cost});
+    graph[from].push_back(id);
+    graph[to].push_back(id + 1);
+    return id;
+}
+
+int64_t MinCostFlow::flowOn(int edge) const {
+    return edges[edge ^ 1].residual;
+}
+
+bool MinCostFlow::augmentShortestPath(int source, int sink, int64_t limit, int64_t& pushed, int64_t& pathCost) {
+    const int64_t unreached = INT64_MAX;
+    distance.assign(graph.size(), unreached);
+    parentEdge.assign(graph.size(), -1);
+
+    // Dijkstra on reduced costs, which the potentials keep non-negative
+    priority_queue<pair<int64_t, int>, vector<pair<int64_t, int>>, greater<pair<int64_t, int>>> pq;
+    distance[source] = 0;
+    pq.push({0, source});
+    STAT_INC(STAT_DIJKSTRA_SEARCHES);
+    STAT_INC(STAT_QUEUE_PUSHES);
+    while (!pq.empty()) {
+        pair<int64_t, int> top = pq.top();
+        pq.pop();
+        int node = top.second;
+        if (top.first > distance[node]) continue;
+        STAT_INC(STAT_NODES_EXPANDED);
+
+        for (int e : graph[node]) {
+            const Edge& edge = edges[e];
+            if (edge.residual <= 0) continue;
+            int64_t candidate = distance[node] + edge.cost + potential[node] - potential[edge.to];
+            if (candidate < distance[edge.to]) {
+                distance[edge.to] = candidate;
+                parentEdge[edge.to] = e;
+                pq.push({candidate, edge.to});
+                STAT_INC(STAT_QUEUE_PUSHES);
+            }
+        }
+    }
+    if (distance[sink] == unreached) return false;
+
+    for (size_t node = 0; node < graph.size(); node++) {
+        if (distance[node] != unreached) potential[node] += distance[node];
+    }
+
+    pushed = limit;
+    for (int node = sink; node != source; node = edges[parentEdge[node] ^ 1].to) {
+        pushed = min(pushed, edges[parentEdge[node]].residual);
+    }
+    pathCost = 0;
+    for (int node = sink; node != source; node = edges[parentEdge[node] ^ 1].to) {
+        int e = parentEdge[node];
+        edges[e].residual -= pushed;
+        edges[e ^ 1].residual += pushed;
+        pathCost += edges[e].cost;
+    }
+    return true;
+}
+
+namespace {
+
+// Edge of the time-expanded network going from time t - 1 to time t
+struct TimedEdge {
+    int edge;
+    RoomId from;
+    RoomId to;
+};
+
+// Network where every room exists once per time step, split into an in and an out node
+// joined by an edge carrying the room capacity. Sv is the source, Sd the sink.
+class TimeExpandedNetwork {
+public:
+    TimeExpandedNetwork(const ColonyInfo& colony, const vector<int>& earliest) : colony(colony), earliest(earliest) {
+        source = network.addNode();
+        sink = network.addNode();
+        layerIn.emplace_back(colony.roomCount(), -1); // Time 0: every ant is still in Sv
+        layerOut.emplace_back(colony.roomCount(), -1);
+        layerEdges.emplace_back();
+    }
+
+    int horizon() const { return layerIn.size() - 1; }
+
+    // Add time horizon() + 1, that is every move that can happen during the next step
+    void addLayer() {
+        int t = horizon() + 1;
+        size_t numRooms = colony.roomCount();
+        layerIn.emplace_back(numRooms, -1);
+        layerOut.emplace_back(numRooms, -1);
+        layerEdges.emplace_back();
+        vector<int>& in = layerIn[t];
+        vector<int>& out = layerOut[t];
+        const vector<int>& previousOut = layerOut[t - 1];
+        vector<TimedEdge>& timed = layerEdges[t];
+
+        for (RoomId room = 0; room < numRooms; room++) {
+            if (earliest[room] > t || room == VESTIBULE) continue;
+            in[room] = network.addNode();
+            out[room] = network.addNode();
+            network.addEdge(in[room], out[room], colony.roomCapacity[room]);
+        }
+
+        for (RoomId room = 0; room < numRooms; room++) {
+            if (previousOut[room] < 0) continue;
+            timed.push_back({network.addEdge(previousOut[room], in[room], INFINITE_CAPACITY), room, room});
+            for (RoomId neighbor : colony.neighbors(room)) {
+                if (neighbor == DORMITORY) {
+                    timed.push_back({network.addEdge(previousOut[room], sink, INFINITE_CAPACITY), room, neighbor});
+                } else if (in[neighbor] >= 0) {
+                    timed.push_back({network.addEdge(previousOut[room], in[neighbor], INFINITE_CAPACITY), room, neighbor});
+                }
+            }
+        }
+
+        // Sv holds every ant and can release any number of them per step
+        for (RoomId neighbor : colony.neighbors(VESTIBULE)) {
+            if (neighbor != DORMITORY && in[neighbor] >= 0) {
+                timed.push_back({network.addEdge(source, in[neighbor], INFINITE_CAPACITY), VESTIBULE, neighbor});
+            }
+        }
+    }
+
+    int64_t augment(int64_t limit) {
+        return network.augment(source, sink, limit);
+    }
+
+    // Turn the flow back into individual ants: they leave Sv in order and every room is FIFO
+    void decode(Schedule& schedule) const {
+        size_t numRooms = colony.roomCount();
+        vector<deque<int>> inside(numRooms);
+        vector<vector<int>> arriving(numRooms);
+        int nextAnt = 0;
+
+        for (int t = 1; t <= horizon(); t++) {
+            vector<TimedEdge> moves;
+            map<pair<RoomId, RoomId>, size_t> moveIndex;
+            vector<int64_t> amount;
+            for (const TimedEdge& timed : layerEdges[t]) {
+                int64_t flow = network.flowOn(timed.edge);
+                if (flow == 0 || timed.from == timed.to) continue;
+                moveIndex[{timed.from, timed.to}] = moves.size();
+                moves.push_back(timed);
+                amount.push_back(flow);
+            }
+
+            // Two groups of ants swapping through the same tunnel is the same as both staying put
+            for (size_t i = 0; i < moves.size(); i++) {
+                auto reverse = moveIndex.find({moves[i].to, moves[i].from});
+                if (reverse == moveIndex.end()) continue;
+                int64_t swapped = min(amount[i], amount[reverse->second]);
+                amount[i] -= swapped;
+                amount[reverse->second] -= swapped;
+            }
+
+            vector<Move> step;
+            for (size_t i = 0; i < moves.size(); i++) {
+                for (int64_t k = 0; k < amount[i]; k++) {
+                    int ant;
+                    if (moves[i].from == VESTIBULE) {
+                        ant = nextAnt++;
+                    } else {
+                        ant = inside[moves[i].from].front();
+                        inside[moves[i].from].pop_front();
+                    }
+                    if (moves[i].to != DORMITORY) arriving[moves[i].to].push_back(ant);
+                    step.push_back({ant, moves[i].from, moves[i].to});
+                }
+            }
+
+            // Ants that stayed keep their place in the queue, newcomers line up behind them
+            for (RoomId room = 0; room < numRooms; room++) {
+                for (int ant : arriving[room]) inside[room].push_back(ant);
+                arriving[room].clear();
+            }
+
+            sort(step.begin(), step.end(), [](const Move& a, const Move& b) { return a.ant < b.ant; });
+            schedule.push_back(step);
+        }
+    }
+
+private:
+    const ColonyInfo& colony;
+    const vector<int>& earliest;
+    MaxFlow network;
+    int source;
+    int sink;
+    vector<vector<int>> layerIn;
+    vector<vector<int>> layerOut;
+    vector<vector<TimedEdge>> layerEdges;
+};
+
+} // namespace
+
+bool solveWithTimeExpandedFlow(const ColonyInfo& colony, Schedule& schedule, int64_t lowerBound) {
+    schedule.clear();
+    int numAnts = colony.numAnts;
+    if (numAnts <= 0) return true;
+
+    // Sd has no capacity limit, so a direct tunnel empties Sv in a single step
+    for (RoomId neighbor : colony.neighbors(VESTIBULE)) {
+        if (neighbor == DORMITORY) {
+            vector<Move> step;
+            for (int ant = 0; ant < numAnts; ant++) {
+                step.push_back({ant, VESTIBULE, DORMITORY});
+            }
+            schedule.push_back(step);
+            return true;
+        }
+    }
+
+    // Earliest time an ant can stand in each room, only through rooms with some capacity
+    size_t numRooms = colony.roomCount();
+    vector<int> earliest(numRooms, UNREACHABLE);
+    vector<RoomId> frontier;
+    frontier.push_back(VESTIBULE);
+    earliest[VESTIBULE] = 0;
+    int shortestArrival = UNREACHABLE;
+
+    for (size_t head = 0; head < frontier.size(); head++) {
+        RoomId room = frontier[head];
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (neighbor == DORMITORY) {
+                shortestArrival = min(shortestArrival, earliest[room] + 1);
+            } else if (earliest[neighbor] == UNREACHABLE && colony.roomCapacity[neighbor] > 0) {
+                earliest[neighbor] = earliest[room] + 1;
+                frontier.push_back(neighbor);
+            }
+        }
+    }
+    if (shortestArrival == UNREACHABLE) return false;
+
+    // Every extra step lets at least one more ant through, so this terminates. No horizon
+    // below the lower bound can carry every ant, so those are never solved.
+    TimeExpandedNetwork network(colony, earliest);
+    int64_t routed = 0;
+    while (network.horizon() < max<int64_t>(shortestArrival, lowerBound)) network.addLayer();
+    routed += network.augment(numAnts);
+    while (routed < numAnts) {
+        network.addLayer();
+        routed += network.augment(numAnts - routed);
+    }
+
+    network.decode(schedule);
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include "ants.hpp"
+
+const int64_t INFINITE_CAPACITY = INT64_MAX / 4;
+
+// Dinic max-flow on a residual graph that can keep growing between augmentations
+class MaxFlow {
+public:
+    int addNode();
+    int addEdge(int from, int to, int64_t capacity); // Returns the id of the forward edge
+    int64_t augment(int source, int sink, int64_t limit); // Pushes at most limit more units
+    int64_t flowOn(int edge) const;
+    size_t nodeCount() const { return graph.size(); }
+
+private:
+    struct Edge {
+        int to;
+        int64_t residual;
+    };
+
+    vector<Edge> edges; // Edge e and e ^ 1 are each other's reverse
+    vector<vector<int>> graph;
+    vector<int> level;
+    vector<size_t> nextEdge;
+    vector<int> path;
+
+    bool buildLevels(int source, int sink);
+    int64_t blockingFlow(int source, int sink, int64_t limit);
+};
+
+// Successive shortest paths min-cost flow (Dijkstra with potentials, costs start non-negative)
+class MinCostFlow {
+public:
+    int addNode();
+    int addEdge(int from, int to, int64_t capacity, int64_t cost); // Returns the id of the forward edge
+    // Push up to limit units along one cheapest augmenting path; false when the sink is unreachable
+    bool augmentShortestPath(int source, int sink, int64_t limit, int64_t& pushed, int64_t& pathCost);
+    int64_t flowOn(int edge) const;
+
+private:
+    struct Edge {
+        int to;
+        int64_t residual;
+        int64_t cost;
+    };
+
+    vector<Edge> edges; // Edge e and e ^ 1 are each other's reverse
+    vector<vector<int>> graph;
+    vector<int64_t> potential;
+    vector<int64_t> distance;
+    vector<int> parentEdge;
+};
+
+// Minimum-step plan on the time-expanded network, extending the horizon until every ant arrives.
+// The horizon starts at the given lower bound on the step count (0 if none) instead of the shortest path.
+bool solveWithTimeExpandedFlow(const ColonyInfo& colony, Schedule& schedule, int64_t lowerBound = 0);
+
+#endif // FLOW_H
@@ -0,0 +1,311 @@
+#include "generator.hpp"
+
+#include <cerrno>
+#include <cmath>
+
+namespace {
+
+const uint64_t GENERATED_VESTIBULE = 0;
+const uint64_t GENERATED_DORMITORY = UINT64_MAX;
+const uint64_t MAX_GENERATED_ROOMS = uint64_t(1) << 31; // Room ids of the loaded colony are 32 bits
+
+// SplitMix64: tiny, seedable and identical on every platform, unlike the std distributions
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t below(uint64_t bound) { return next() % bound; }
+
+private:
+    uint64_t state;
+};
+
+// Writes the file line by line; only counters are kept, never the rooms or tunnels
+class ColonyStream {
+public:
+    ColonyStream(OutputWriter& out, const GeneratorOptions& options)
+        : out(out), options(options), capacityRandom(options.seed), tunnelRandom(options.seed ^ 0x5851F42D4C957F2DULL) {}
+
+    Random& random() { return tunnelRandom; }
+
+    void header() { out << "f=" << options.ants << '\n'; }
+
+    void room(uint64_t id, int capacity) {
+        out << 'S' << id << " { " << capacity << " }\n";
+        roomsWritten++;
+    }
+
+    // Capacities come from their own generator so the topology does not depend on them
+    void room(uint64_t id) {
+        int span = options.maxCapacity - options.minCapacity + 1;
+        room(id, options.minCapacity + int(capacityRandom.below(span)));
+    }
+
+    void tunnel(uint64_t a, uint64_t b) {
+        writeName(a);
+        out << " - ";
+        writeName(b);
+        out << '\n';
+        tunnelsWritten++;
+    }
+
+    uint64_t roomsWritten = 0;
+    uint64_t tunnelsWritten = 0;
+
+private:
+    void writeName(uint64_t id) {
+        if (id == GENERATED_VESTIBULE) {
+            out << "Sv";
+        } else if (id == GENERATED_DORMITORY) {
+            out << "Sd";
+        } else {
+            out << 'S' << id;
+        }
+    }
+
+    OutputWriter& out;
+    const GeneratorOptions& options;
+    Random capacityRandom;
+    Random tunnelRandom;
+};
+
+uint64_t integerRoot(uint64_t value, int degree) {
+    uint64_t root = uint64_t(pow(double(value), 1.0 / degree));
+    auto power = [degree](uint64_t x) {
+        uint64_t result = 1;
+        for (int i = 0; i < degree; i++) result *= x;
+        return result;
+    };
+    while (root > 1 && power(root) > value) root--;
+    while (power(root + 1) <= value) root++;
+    return max<uint64_t>(root, 1);
+}
+
+// W x H rooms, Sv above the first row and Sd below the last one
+void generateGrid(ColonyStream& colony, uint64_t rooms, uint64_t width) {
+    uint64_t w = width ? width : integerRoot(rooms, 2);
+    uint64_t h = max<uint64_t>(rooms / w, 1);
+    for (uint64_t id = 1; id <= w * h; id++) colony.room(id);
+
+    for (uint64_t x = 0; x < w; x++) colony.tunnel(GENERATED_VESTIBULE, x + 1);
+    for (uint64_t y = 0; y < h; y++) {
+        for (uint64_t x = 0; x < w; x++) {
+            uint64_t id = y * w + x + 1;
+            if (x + 1 < w) colony.tunnel(id, id + 1);
+            if (y + 1 < h) colony.tunnel(id, id + w);
+        }
+    }
+    for (uint64_t x = 0; x < w; x++) colony.tunnel((h - 1) * w + x + 1, GENERATED_DORMITORY);
+}
+
+// Layers of W x W rooms stacked on top of each other, Sv on the first layer and Sd on the last
+void generateLattice(ColonyStream& colony, uint64_t rooms, uint64_t width) {
+    uint64_t w = width ? width : integerRoot(rooms, 3);
+    uint64_t layer = w * w;
+    uint64_t depth = max<uint64_t>(rooms / layer, 1);
+    for (uint64_t id = 1; id <= layer * depth; id++) colony.room(id);
+
+    for (uint64_t i = 0; i < layer; i++) colony.tunnel(GENERATED_VESTIBULE, i + 1);
+    for (uint64_t z = 0; z < depth; z++) {
+        for (uint64_t y = 0; y < w; y++) {
+            for (uint64_t x = 0; x < w; x++) {
+                uint64_t id = z * layer + y * w + x + 1;
+                if (x + 1 < w) colony.tunnel(id, id + 1);
+                if (y + 1 < w) colony.tunnel(id, id + w);
+                if (z + 1 < depth) colony.tunnel(id, id + layer);
+            }
+        }
+    }
+    for (uint64_t i = 0; i < layer; i++) colony.tunnel((depth - 1) * layer + i + 1, GENERATED_DORMITORY);
+}
+
+// Random recursive tree (every room joins an earlier one, so all are connected) plus random
+// extra tunnels up to the requested average degree; Sv on the first rooms, Sd on random ones
+void generateRandom(ColonyStream& colony, uint64_t rooms, uint64_t width, uint64_t degree) {
+    uint64_t entries = min(width ? width : 1, rooms);
+    for (uint64_t id = 1; id <= rooms; id++) colony.room(id);
+
+    Random& random = colony.random();
+    for (uint64_t id = 1; id <= entries; id++) colony.tunnel(GENERATED_VESTIBULE, id);
+    for (uint64_t id = 2; id <= rooms; id++) colony.tunnel(id, 1 + random.below(id - 1));
+
+    uint64_t wanted = rooms * degree / 2;
+    uint64_t extra = wanted > rooms - 1 ? wanted - (rooms - 1) : 0;
+    for (uint64_t i = 0; i < extra; i++) {
+        uint64_t a = 1 + random.below(rooms);
+        uint64_t b = 1 + random.below(rooms);
+        if (a != b) colony.tunnel(a, b);
+    }
+    for (uint64_t i = 0; i < entries; i++) colony.tunnel(1 + random.below(rooms), GENERATED_DORMITORY);
+}
+
+// Stages of W parallel rooms, each stage draining through a single narrow room
+void generateChain(ColonyStream& colony, uint64_t rooms, uint64_t width, int bottleneck) {
+    uint64_t w = width ? width : 4;
+    uint64_t stage = w + 1;
+    uint64_t stages = max<uint64_t>(rooms / stage, 1);
+    for (uint64_t s = 0; s < stages; s++) {
+        for (uint64_t i = 1; i <= w; i++) colony.room(s * stage + i);
+        colony.room(s * stage + stage, bottleneck);
+    }
+
+    for (uint64_t s = 0; s < stages; s++) {
+        uint64_t entry = s == 0 ? GENERATED_VESTIBULE : s * stage;
+        for (uint64_t i = 1; i <= w; i++) {
+            colony.tunnel(entry, s * stage + i);
+            colony.tunnel(s * stage + i, s * stage + stage);
+        }
+    }
+    colony.tunnel(stages * stage, GENERATED_DORMITORY);
+}
+
+// W independent corridors leaving Sv side by side, all ending in Sd
+void generateFanout(ColonyStream& colony, uint64_t rooms, uint64_t width) {
+    uint64_t w = width ? width : integerRoot(rooms, 2);
+    uint64_t length = max<uint64_t>(rooms / w, 1);
+    for (uint64_t id = 1; id <= w * length; id++) colony.room(id);
+
+    for (uint64_t b = 0; b < w; b++) {
+        uint64_t first = b * length + 1;
+        colony.tunnel(GENERATED_VESTIBULE, first);
+        for (uint64_t d = 1; d < length; d++) colony.tunnel(first + d - 1, first + d);
+        colony.tunnel(first + length - 1, GENERATED_DORMITORY);
+    }
+}
+
+bool parseNumber(const string& text, uint64_t& value) {
+    char* end;
+    errno = 0;
+    value = strtoull(text.c_str(), &end, 10);
+    return !text.empty() && text[0] != '-' && *end == '\0' && errno == 0;
+}
+
+bool parseCapacity(const string& text, int& value) {
+    uint64_t parsed;
+    if (!parseNumber(text, parsed) || parsed > uint64_t(INT_MAX)) return false;
+    value = int(parsed);
+    return true;
+}
+
+void printGenerateUsage() {
+    cerr << "Usage: generate [--family=grid|lattice|random|chain|fanout] [--rooms=N] [--ants=N] [--width=N]"
+         << " [--degree=N] [--capacity=C|MIN-MAX] [--bottleneck=C] [--seed=N] [--output=FILE]" << endl;
+}
+
+} // namespace
+
+bool generateColony(OutputWriter& out, const GeneratorOptions& options) {
+    ColonyStream colony(out, options);
+    colony.header();
+
+    if (options.family == "grid") {
+        generateGrid(colony, options.rooms, options.width);
+    } else if (options.family == "lattice") {
+        generateLattice(colony, options.rooms, options.width);
+    } else if (options.family == "random") {
+        generateRandom(colony, options.rooms, options.width, options.degree);
+    } else if (options.family == "chain") {
+        generateChain(colony, options.rooms, options.width, options.bottleneck);
+    } else if (options.family == "fanout") {
+        generateFanout(colony, options.rooms, options.width);
+    } else {
+        return false;
+    }
+
+    cerr << "Generated " << colony.roomsWritten << " rooms and " << colony.tunnelsWritten << " tunnels" << endl;
+    return true;
+}
+
+int runGenerate(int argc, char* argv[]) {
+    GeneratorOptions options;
+    string outputFile;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        size_t equals = arg.find('=');
+        string name = arg.substr(0, equals);
+        string value = equals == string::npos ? "" : arg.substr(equals + 1);
+        bool valid = equals != string::npos;
+
+        if (name == "--family") {
+            options.family = value;
+        } else if (name == "--rooms") {
+            valid = valid && parseNumber(value, options.rooms) && options.rooms >= 1;
+        } else if (name == "--ants") {
+            valid = valid && parseNumber(value, options.ants) && options.ants <= uint64_t(INT_MAX);
+        } else if (name == "--width") {
+            valid = valid && parseNumber(value, options.width);
+        } else if (name == "--degree") {
+            valid = valid && parseNumber(value, options.degree);
+        } else if (name == "--capacity") {
+            size_t dash = value.find('-');
+            if (dash == string::npos) {
+                valid = valid && parseCapacity(value, options.minCapacity);
+                options.maxCapacity = options.minCapacity;
+            } else {
+                valid = valid && parseCapacity(value.substr(0, dash), options.minCapacity) &&
+                        parseCapacity(value.substr(dash + 1), options.maxCapacity);
+            }
+            valid = valid && options.minCapacity >= 1 && options.minCapacity <= options.maxCapacity;
+        } else if (name == "--bottleneck") {
+            valid = valid && parseCapacity(value, options.bottleneck) && options.bottleneck >= 1;
+        } else if (name == "--seed") {
+            valid = valid && parseNumber(value, options.seed);
+        } else if (name == "--output") {
+            outputFile = value;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            printGenerateUsage();
+            return 1;
+        }
+    }
+
+    if (options.family != "grid" && options.family != "lattice" && options.family != "random" &&
+        options.family != "chain" && options.family != "fanout") {
+        cerr << "Error: unknown family " << options.family << " (expected grid, lattice, random, chain or fanout)" << endl;
+        return 1;
+    }
+    if (options.rooms > MAX_GENERATED_ROOMS || options.width > options.rooms) {
+        cerr << "Error: at most " << MAX_GENERATED_ROOMS << " rooms, and no wider than the room count" << endl;
+        return 1;
+    }
+    if (options.family == "lattice" && options.width * options.width > options.rooms) {
+        cerr << "Error: a lattice layer of width " << options.width << " needs more than " << options.rooms << " rooms" << endl;
+        return 1;
+    }
+    if (options.degree > options.rooms) {
+        cerr << "Error: average degree " << options.degree << " is larger than the room count" << endl;
+        return 1;
+    }
+
+    FILE* stream = stdout;
+    if (!outputFile.empty()) {
+        stream = fopen(outputFile.c_str(), "w");
+        if (!stream) {
+            cerr << "Error: unable to write file " << outputFile << endl;
+            return 1;
+        }
+    }
+    {
+        OutputWriter out(stream);
+        generateColony(out, options);
+    }
+    // The writer flushed on the way out, so a failed write (full disk, closed pipe) shows up here
+    bool written = !ferror(stream);
+    if (stream != stdout && fclose(stream) != 0) written = false;
+    if (!written) {
+        cerr << "Error: failed while writing " << (outputFile.empty() ? "the colony" : outputFile) << endl;
+        return 1;
+    }
+    return 0;
+}
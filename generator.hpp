@@ -0,0 +1,25 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "output.hpp"
+
+// Shape of a synthetic colony; rooms are named S1..Sn and written before the tunnels
+struct GeneratorOptions {
+    string family = "grid";   // grid, lattice, random, chain or fanout
+    uint64_t rooms = 100;     // Target room count (rounded down to the family's shape)
+    uint64_t ants = 100;
+    uint64_t width = 0;       // Family-specific width, 0 picks a default from rooms
+    uint64_t degree = 3;      // Average tunnels per room (random family)
+    int minCapacity = 1;      // Capacities are drawn uniformly in [minCapacity, maxCapacity]
+    int maxCapacity = 1;
+    int bottleneck = 1;       // Capacity of the narrow rooms (chain family)
+    uint64_t seed = 1;
+};
+
+// Stream the colony to out; memory does not depend on the colony size
+bool generateColony(OutputWriter& out, const GeneratorOptions& options);
+
+// "generate" subcommand: write a synthetic colony to stdout or --output=FILE
+int runGenerate(int argc, char* argv[]);
+
+#endif // GENERATOR_H
@@ -0,0 +1,105 @@
+#include "incremental_paths.hpp"
+#include "dijkstra.hpp"
+#include "stats.hpp"
+
+IncrementalCongestionPaths::IncrementalCongestionPaths(const ColonyInfo& colony) : colony(colony) {
+    size_t numRooms = colony.roomCount();
+    vector<int> emptyColony(numRooms, 0);
+    enterable.assign(numRooms, 0);
+    weight.assign(numRooms, 0);
+    g.assign(numRooms, INFINITE);
+    rhs.assign(numRooms, INFINITE);
+
+    for (RoomId room = 0; room < numRooms; room++) {
+        enterable[room] = room == DORMITORY || (room != VESTIBULE && colony.roomDeclared[room]);
+        weight[room] = edgeCost(room, emptyColony);
+    }
+
+    // The first repair is a plain Dijkstra from Sd
+    rhs[DORMITORY] = 0;
+    inconsistent.push({0, DORMITORY});
+    STAT_INC(STAT_QUEUE_PUSHES);
+    repair();
+}
+
+int64_t IncrementalCongestionPaths::edgeCost(RoomId room, const vector<int>& occupancy) const {
+    return (int64_t(congestionWeight(colony, room, occupancy)) << HOP_BITS) + 1;
+}
+
+// Cheapest weight + g over the enterable neighbors of a room; ties go to the smallest room id,
+// as in CongestionSearch
+int64_t IncrementalCongestionPaths::bestThroughNeighbors(RoomId room, RoomId& bestNeighbor) const {
+    int64_t best = INFINITE;
+    bestNeighbor = NO_ROOM;
+    for (RoomId neighbor : colony.neighbors(room)) {
+        if (!enterable[neighbor] || g[neighbor] == INFINITE) continue;
+        int64_t candidate = weight[neighbor] + g[neighbor];
+        if (candidate < best || (candidate == best && neighbor < bestNeighbor)) {
+            best = candidate;
+            bestNeighbor = neighbor;
+        }
+    }
+    return best;
+}
+
+// Recompute the lookahead of a room and queue it if it no longer matches its distance
+void IncrementalCongestionPaths::updateRoom(RoomId room) {
+    if (room != DORMITORY) {
+        RoomId unused;
+        rhs[room] = bestThroughNeighbors(room, unused);
+    }
+    if (g[room] != rhs[room]) {
+        inconsistent.push({min(g[room], rhs[room]), room});
+        STAT_INC(STAT_QUEUE_PUSHES);
+    }
+}
+
+void IncrementalCongestionPaths::roomChanged(RoomId room, const vector<int>& tempOccupancy) {
+    if (room == VESTIBULE || room == DORMITORY) return;
+    int64_t cost = edgeCost(room, tempOccupancy);
+    if (cost == weight[room]) return; // Still in the same congestion band
+
+    // Only the rooms next to it can reach Sd through it
+    weight[room] = cost;
+    for (RoomId neighbor : colony.neighbors(room)) {
+        if (enterable[neighbor]) updateRoom(neighbor);
+    }
+}
+
+// Settle every queued room in distance order; rooms whose distance did not change are never touched
+void IncrementalCongestionPaths::repair() {
+    while (!inconsistent.empty()) {
+        pair<int64_t, RoomId> top = inconsistent.top();
+        inconsistent.pop();
+        RoomId room = top.second;
+        if (g[room] == rhs[room] || top.first != min(g[room], rhs[room])) continue; // Stale entry
+        STAT_INC(STAT_NODES_EXPANDED);
+
+        if (g[room] > rhs[room]) {
+            g[room] = rhs[room]; // Got cheaper: settle it
+        } else {
+            g[room] = INFINITE; // Got dearer: recompute it from its neighbors
+            updateRoom(room);
+        }
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (enterable[neighbor]) updateRoom(neighbor);
+        }
+    }
+}
+
+RoomId IncrementalCongestionPaths::nextOnPath(RoomId start, int& pathRooms) {
+    STAT_INC(STAT_INCREMENTAL_QUERIES);
+    repair();
+    RoomId next;
+    int64_t best = bestThroughNeighbors(start, next);
+    pathRooms = best == INFINITE ? 0 : int(best & ((int64_t(1) << HOP_BITS) - 1)) + 1;
+    return next;
+}
+
+int64_t IncrementalCongestionPaths::pathCost(RoomId start) {
+    repair();
+    if (start == DORMITORY) return 0;
+    RoomId next;
+    int64_t best = bestThroughNeighbors(start, next);
+    return best == INFINITE ? -1 : best >> HOP_BITS;
+}
@@ -0,0 +1,47 @@
+#ifndef INCREMENTAL_PATHS_H
+#define INCREMENTAL_PATHS_H
+
+#include "ants.hpp"
+
+// Congestion-aware distances to Sd kept alive across ants and steps (LPA* / DynamicSWSF-FP
+// rooted at Sd). Entering a room costs its congestion weight (1, 5 above 70% of capacity,
+// 100 when full) and, like findShortestPathDijkstra, paths only go through declared rooms.
+// When a planned move changes the weight of a room, only the rooms whose distance depended
+// on it are repaired, lazily, before the next query.
+//
+// Distances are (cost, hops) pairs packed in one integer, so among equally cheap paths the
+// one with the fewest rooms wins, and among those the first room with the smallest id: the
+// same path as CongestionSearch, whatever the search order.
+class IncrementalCongestionPaths {
+public:
+    explicit IncrementalCongestionPaths(const ColonyInfo& colony);
+
+    // An ant moved from one room to another in tempOccupancy (Sv and Sd never change weight)
+    void roomChanged(RoomId room, const vector<int>& tempOccupancy);
+
+    // First room of the cheapest path from start to Sd (NO_ROOM if none) and the number of rooms
+    // on that path including start (0 if none), like findShortestPathDijkstra(...).size()
+    RoomId nextOnPath(RoomId start, int& pathRooms);
+
+    // Cost of the cheapest path from start to Sd with the current weights (-1 if none),
+    // the same as the cost of the path findShortestPathDijkstra returns
+    int64_t pathCost(RoomId start);
+
+private:
+    static constexpr int64_t INFINITE = INT64_MAX;
+    static constexpr int HOP_BITS = 32;
+
+    const ColonyInfo& colony;
+    vector<char> enterable;  // Declared rooms and Sd
+    vector<int64_t> weight;  // Packed cost of entering each room
+    vector<int64_t> g;       // Current distance to Sd
+    vector<int64_t> rhs;     // One-step lookahead: min over neighbors of weight + g
+    priority_queue<pair<int64_t, RoomId>, vector<pair<int64_t, RoomId>>, greater<pair<int64_t, RoomId>>> inconsistent;
+
+    int64_t edgeCost(RoomId room, const vector<int>& occupancy) const;
+    int64_t bestThroughNeighbors(RoomId room, RoomId& bestNeighbor) const;
+    void updateRoom(RoomId room);
+    void repair();
+};
+
+#endif // INCREMENTAL_PATHS_H
@@ -1,108 +1,300 @@
+#include "aggregate.hpp"
+#include "analysis.hpp"
 #include "ants.hpp"
+#include "compiled_colony.hpp"
+#include "batch.hpp"
+#include "bounds.hpp"
+#include "generator.hpp"
+#include "output.hpp"
+#include "reduction.hpp"
+#include "server.hpp"
+#include "solvers.hpp"
+#include "stats.hpp"
+#include "uneviedefourmi.hpp"
 
-// Main program loop
-int main(int argc, char* argv[]) {
-    string filename;
+#include <chrono>
 
-    if (argc > 1) {
-        filename = argv[1];
-    } else {
-        cout << "Enter the ant colony filename: ";
-        cin >> filename;
+// Command line on top of libuneviedefourmi: parse the options, load the colony, run a Simulation
+// and print its steps as they come
+
+// Aggregate engine (event driven for the events solver): each step is written out as soon as it
+// is planned, nothing is kept per ant and batches are printed as such (Simulation would spread
+// them into one move per ant)
+static bool runAggregateSimulation(const ColonyInfo& colony, bool eventDriven, OutputWriter& report, TraceFormat trace, bool expand,
+                                   size_t& steps, double& solveTime) {
+    auto start = chrono::steady_clock::now();
+    ColonyInfo pruned = withoutDeadRooms(colony);
+    AggregateSimulation simulation(pruned, eventDriven);
+    solveTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    steps = 0;
+    if (!simulation.finished() && !simulation.reachable()) return false;
+
+    unique_ptr<OutputWriter> traceOut;
+    if (trace == TRACE_BINARY) {
+        traceOut = make_unique<OutputWriter>(stdout);
+        writeTraceHeader(*traceOut, 0, 0);
     }
 
-    if (!loadColonyFromFile(filename)) {
-        return 1;
+    AggregateStep moves;
+    int64_t stepLimit = simulationStepLimit(colony);
+    while (!simulation.finished() && int64_t(steps) < stepLimit) {
+        start = chrono::steady_clock::now();
+        bool moved = simulation.step(moves);
+        solveTime += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!moved) break;
+        steps++;
+
+        if (trace == TRACE_TEXT) {
+            printAggregateStep(report, colony, steps, moves, expand);
+        } else if (trace == TRACE_BINARY) {
+            writeTraceStep(*traceOut, steps, moves);
+        }
     }
+    return true;
+}
 
-    printColonyInfo();
+static void printSummary(OutputWriter& report, const ColonyInfo& colony, size_t steps, int64_t lowerBound, const string& solver,
+                         double loadTime, double boundTime, double solveTime) {
+    report << "All ants have reached Sd in " << steps << " steps!";
+    if (lowerBound > 0) {
+        report << " (lower bound: " << lowerBound << (int64_t(steps) == lowerBound ? ", optimal)" : ")");
+    }
+    report << "\n\n";
 
-    // Create ants
-    vector<Ant> ants;
-    for (int i = 1; i <= colonyInfo.numAnts; ++i) {
-        ants.push_back(Ant("f" + to_string(i)));
+    report << "+++ Performance Statistics +++\n";
+    report << "File loading time: ";
+    report.writeFixed(loadTime, 6);
+    report << " seconds";
+    if (loadTime > 0) {
+        report << " (";
+        report.writeFixed(colony.sourceBytes / loadTime / 1e6, 2);
+        report << " MB/s)";
     }
+    report << '\n';
+    report << "Lower bound time: ";
+    report.writeFixed(boundTime, 6);
+    report << " seconds\n";
+    report << "Solver: " << solver << '\n';
+    report << "Solver time: ";
+    report.writeFixed(solveTime, 6);
+    report << " seconds\n";
+}
 
-    cout << "Starting simulation with " << ants.size() << " ants" << endl;
-    cout << endl;
+// --stats=json goes to stderr, after everything meant for humans
+static void printStats(OutputWriter& report, const vector<PhaseTime>& phases) {
+    report.flush();
+    OutputWriter out(stderr);
+    writeStatsJson(out, collectStats(), phases);
+}
+
+// Main program loop
+int main(int argc, char* argv[]) {
+    // uneviedefourmi compile colony.txt colony.uvc
+    if (argc > 1 && string(argv[1]) == "compile") {
+        if (argc != 4) {
+            cout << "Usage: " << argv[0] << " compile <colony.txt> <output>" << endl;
+            return 1;
+        }
+        Colony colony;
+        if (!colony.load(argv[2]) || !writeCompiledColony(colony.info(), argv[3])) {
+            return 1;
+        }
+        cout << "Compiled " << colony.roomCount() << " rooms and " << colony.info().tunnels.size() / 2
+             << " tunnels into " << argv[3] << endl;
+        return 0;
+    }
 
-    int step = 1;
-    bool allFinished = false;
+    // uneviedefourmi batch [options] <directory or files...>
+    if (argc > 1 && string(argv[1]) == "batch") {
+        return runBatch(argc - 2, argv + 2);
+    }
 
-    while (!allFinished && step <= 50) { // Safety limit
-        allFinished = true;
+    // uneviedefourmi generate --family=grid --rooms=1000000 --ants=10000000 --output=colony.txt
+    if (argc > 1 && string(argv[1]) == "generate") {
+        return runGenerate(argc - 2, argv + 2);
+    }
 
-        vector<pair<int, string>> plannedMoves;
-        map<string, int> tempOccupancy = roomOccupancy;
+    // uneviedefourmi analyze [--output=report.json] colony.txt
+    if (argc > 1 && string(argv[1]) == "analyze") {
+        return runAnalyze(argc - 2, argv + 2);
+    }
 
-        // Sort ants by priority
-        vector<int> antOrder;
-        for (int i = 0; i < ants.size(); i++) {
-            if (!ants[i].finished) {
-                antOrder.push_back(i);
-            }
-        }
+    // uneviedefourmi serve [--socket=/tmp/uneviedefourmi.sock] [--threads=8] [--cache=64]
+    if (argc > 1 && string(argv[1]) == "serve") {
+        return runServer(argc - 2, argv + 2);
+    }
 
-        // Prioritize ants closest to Sd
-        sort(antOrder.begin(), antOrder.end(), [&](int a, int b) {
-            vector<string> pathA = findShortestPath(ants[a].position, "Sd");
-            vector<string> pathB = findShortestPath(ants[b].position, "Sd");
+    string filename;
+    string solver = "greedy";
+    PathStrategy strategy = STRATEGY_BFS;
+    TraceFormat trace = TRACE_TEXT;
+    bool expand = false;
+    size_t plannerThreads = 0;
+    bool stats = false;
+    string routeCache;
+    bool segments = false;
 
-            if (pathA.size() == pathB.size()) {
-                return a < b; // if both ants at same distance, f1 before f2, etc.
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 9, "--solver=") == 0) {
+            solver = arg.substr(9);
+        } else if (arg.compare(0, 11, "--strategy=") == 0) {
+            if (!parseStrategy(arg.substr(11), strategy)) {
+                cout << "Error: unknown strategy " << arg.substr(11) << " (expected bfs, dijkstra, dijkstra-scratch, astar or flow)" << endl;
+                return 1;
             }
-            return pathA.size() < pathB.size(); // Closest ant to Sd moves first
-        });
-
-        // Plan next moves
-        for (int antIndex : antOrder) {
-            Ant& ant = ants[antIndex];
-            string current = ant.position;
-
-            string nextRoom = chooseBestNextRoom(current, tempOccupancy);
-
-            if (!nextRoom.empty()) {
-                plannedMoves.push_back({antIndex, nextRoom});
-
-                // Update temporary occupancy
-                if (current != "Sv" && current != "Sd") {
-                    tempOccupancy[current]--;
-                }
-                if (nextRoom != "Sv" && nextRoom != "Sd") {
-                    tempOccupancy[nextRoom]++;
-                }
+        } else if (arg == "--threads" || arg.compare(0, 10, "--threads=") == 0) {
+            string count = arg == "--threads" ? (i + 1 < argc ? argv[++i] : "") : arg.substr(10);
+            char* end;
+            long threads = strtol(count.c_str(), &end, 10);
+            if (count.empty() || *end != '\0' || threads <= 0) {
+                cout << "Error: invalid thread count " << count << endl;
+                return 1;
             }
-
-            if (ant.position != "Sd") allFinished = false;
+            plannerThreads = threads;
+        } else if (arg == "--trace=text") {
+            trace = TRACE_TEXT;
+        } else if (arg == "--trace=binary") {
+            trace = TRACE_BINARY;
+        } else if (arg == "--expand") {
+            expand = true;
+        } else if (arg == "--quiet") {
+            trace = TRACE_NONE;
+        } else if (arg.compare(0, 14, "--route-cache=") == 0) {
+            routeCache = arg.substr(14);
+        } else if (arg == "--segments") {
+            segments = true;
+        } else if (arg == "--stats=json") {
+            stats = true;
+        } else if (arg.compare(0, 8, "--stats=") == 0) {
+            cout << "Error: unknown stats format " << arg.substr(8) << " (expected json)" << endl;
+            return 1;
+        } else if (arg.compare(0, 8, "--trace=") == 0) {
+            cout << "Error: unknown trace format " << arg.substr(8) << " (expected text or binary)" << endl;
+            return 1;
+        } else {
+            filename = arg;
         }
+    }
+
+    if (!isKnownSolver(solver)) {
+        cout << "Error: unknown solver " << solver << " (expected greedy, flow, paths, aggregate or events)" << endl;
+        return 1;
+    }
+    if (plannerThreads > 0 && strategy != STRATEGY_BFS) {
+        cout << "Error: --threads only applies to the bfs strategy" << endl;
+        return 1;
+    }
+    if (!routeCache.empty() && solver != "paths") {
+        cout << "Error: --route-cache only applies to the paths solver" << endl;
+        return 1;
+    }
+    if (segments && solver != "paths") {
+        cout << "Error: --segments only applies to the paths solver" << endl;
+        return 1;
+    }
+    if (segments && !routeCache.empty()) {
+        cout << "Error: --segments and --route-cache cannot be used together" << endl;
+        return 1;
+    }
+    if (stats && !statsEnabled()) {
+        cout << "Error: --stats needs a build with -DUNEVIEDEFOURMI_STATS=ON" << endl;
+        return 1;
+    }
+
+    if (filename.empty()) {
+        cout << "Enter the ant colony filename: ";
+        cin >> filename;
+    }
 
-        // Apply planned moves
-        if (!plannedMoves.empty()) {
-            cout << "+++ Step " << step << " +++" << endl;
+    resetStats();
+    Colony colony;
+    auto startLoad = chrono::steady_clock::now();
+    if (!colony.load(filename)) {
+        return 1;
+    }
+    double loadTime = chrono::duration<double>(chrono::steady_clock::now() - startLoad).count();
 
-            for (auto& move : plannedMoves) {
-                int idx = move.first;
-                string from = ants[idx].position;
-                string to = move.second;
+    // Fewest steps any solver could take: printed with the result, and the flow and paths
+    // solvers stop once they reach it
+    auto startBound = chrono::steady_clock::now();
+    StepLowerBound bound;
+    computeStepLowerBound(colony.info(), bound);
+    double boundTime = chrono::duration<double>(chrono::steady_clock::now() - startBound).count();
 
-                // Update real occupancy
-                if (from != "Sv" && from != "Sd") roomOccupancy[from]--;
-                if (to != "Sv" && to != "Sd") roomOccupancy[to]++;
+    // A binary trace owns stdout, everything meant for humans goes to stderr
+    OutputWriter report(trace == TRACE_BINARY ? stderr : stdout);
 
-                ants[idx].position = to;
-                if (to == "Sd") ants[idx].finished = true;
+    if (trace != TRACE_NONE) {
+        printColonyInfo(report, colony.info());
+        report << "Starting simulation with " << colony.antCount() << " ants";
+        if (solver == "greedy" && (strategy == STRATEGY_DIJKSTRA || strategy == STRATEGY_DIJKSTRA_SCRATCH)) report << " (using Dijkstra algorithm)";
+        if (solver == "greedy" && strategy == STRATEGY_ASTAR) report << " (using A* search)";
+        if (solver == "greedy" && strategy == STRATEGY_FLOW) report << " (following max-flow routes)";
+        if (solver == "flow") report << " (using time-expanded max-flow)";
+        if (solver == "paths") report << (segments ? " (using route sets planned segment by segment)" : " (using a precomputed route set)");
+        if (solver == "aggregate") report << " (moving ants in batches along shortest paths only)";
+        if (solver == "events") report << " (moving ants in batches along shortest paths only, from the rooms that can move)";
+        if (solver == "greedy" && plannerThreads > 0) report << " (planning on " << plannerThreads << " threads)";
+        if (segments && plannerThreads > 0) report << " (segments planned on " << plannerThreads << " threads)";
+        report << "\n\n";
+    }
 
-                cout << ants[idx].name << " - " << from << " - " << to << endl;
-            }
+    if (solver == "aggregate" || solver == "events") {
+        size_t steps;
+        double solveTime;
+        auto startRun = chrono::steady_clock::now();
+        if (!runAggregateSimulation(colony.info(), solver == "events", report, trace, expand, steps, solveTime)) {
+            report << "Error: no path from Sv to Sd\n";
+            return 1;
+        }
+        // Steps are written while they are planned, the output is whatever was not planning
+        double outputTime = chrono::duration<double>(chrono::steady_clock::now() - startRun).count() - solveTime;
+        printSummary(report, colony.info(), steps, bound.steps, solver, loadTime, boundTime, solveTime);
+        if (stats) printStats(report, {{"load", loadTime}, {"bound", boundTime}, {"solve", solveTime}, {"output", outputTime}});
+        return 0;
+    }
 
-            cout << endl;
-            step++;
-        } else {
-            break;
+    // Steps are written as soon as they are taken; the flow and paths solvers plan everything
+    // when the simulation is created
+    SimulationOptions options;
+    options.solver = solver;
+    options.strategy = strategy;
+    options.plannerThreads = plannerThreads;
+    options.lowerBound = bound.steps;
+    options.routeCache = routeCache;
+    options.segments = segments;
+    auto startRun = chrono::steady_clock::now();
+    Simulation simulation(colony, options);
+    double solveTime = chrono::duration<double>(chrono::steady_clock::now() - startRun).count();
+    if (!simulation.reachable()) {
+        report << "Error: no path from Sv to Sd\n";
+        return 1;
+    }
+
+    unique_ptr<OutputWriter> traceOut;
+    if (trace == TRACE_BINARY) {
+        traceOut = make_unique<OutputWriter>(stdout);
+        writeTraceHeader(*traceOut, 0, 0);
+    }
+    while (true) {
+        auto startStep = chrono::steady_clock::now();
+        ArrayView<Move> moves = simulation.step();
+        solveTime += chrono::duration<double>(chrono::steady_clock::now() - startStep).count();
+        if (moves.empty()) break;
+
+        if (trace == TRACE_TEXT) {
+            printStep(report, colony.info(), simulation.stepCount(), moves);
+        } else if (trace == TRACE_BINARY) {
+            writeTraceStep(*traceOut, simulation.stepCount(), moves);
         }
     }
+    double outputTime = chrono::duration<double>(chrono::steady_clock::now() - startRun).count() - solveTime;
 
-    cout << "All ants have reached Sd in " << step - 1 << " steps!" << endl;
+    string solverLabel = solver;
+    if (solver == "greedy" && strategy != STRATEGY_BFS) solverLabel += string(" (") + strategyName(strategy) + " strategy)";
+    printSummary(report, colony.info(), simulation.stepCount(), bound.steps, solverLabel, loadTime, boundTime, solveTime);
+    if (stats) printStats(report, {{"load", loadTime}, {"bound", boundTime}, {"solve", solveTime}, {"output", outputTime}});
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,55 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        length = info.st_size;
+        if (length > 0) {
+            void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, length, MADV_SEQUENTIAL);
+                bytes = static_cast<const char*>(address);
+                mapped = true;
+            }
+        }
+        if (mapped || length == 0) {
+            ::close(fd);
+            return true;
+        }
+    }
+
+    // Not mappable: read everything into memory instead
+    char chunk[1 << 16];
+    ssize_t count;
+    while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+        buffer.insert(buffer.end(), chunk, chunk + count);
+    }
+    ::close(fd);
+    if (count < 0) return false;
+
+    bytes = buffer.data();
+    length = buffer.size();
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) munmap(const_cast<char*>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+    std::vector<char>().swap(buffer);
+}
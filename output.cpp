@@ -0,0 +1,197 @@
+#include "output.hpp"
+
+#include <charconv>
+#include <cstring>
+
+OutputWriter::OutputWriter(FILE* stream, size_t capacity) : stream(stream), buffer(capacity) {}
+
+OutputWriter::OutputWriter(string& target, size_t capacity) : target(&target), buffer(capacity) {}
+
+OutputWriter::~OutputWriter() {
+    flush();
+}
+
+char* OutputWriter::reserve(size_t size) {
+    if (used + size > buffer.size()) {
+        flush();
+        if (size > buffer.size()) buffer.resize(size);
+    }
+    return buffer.data() + used;
+}
+
+void OutputWriter::writeBytes(const void* bytes, size_t size) {
+    // Large blocks skip the buffer instead of growing it
+    if (size > buffer.size()) {
+        flush();
+        if (target) {
+            target->append(static_cast<const char*>(bytes), size);
+        } else {
+            fwrite(bytes, 1, size, stream);
+        }
+        return;
+    }
+    memcpy(reserve(size), bytes, size);
+    used += size;
+}
+
+OutputWriter& OutputWriter::operator<<(string_view text) {
+    writeBytes(text.data(), text.size());
+    return *this;
+}
+
+OutputWriter& OutputWriter::operator<<(char c) {
+    *reserve(1) = c;
+    used++;
+    return *this;
+}
+
+OutputWriter& OutputWriter::operator<<(int64_t value) {
+    char* first = reserve(20);
+    used = to_chars(first, first + 20, value).ptr - buffer.data();
+    return *this;
+}
+
+void OutputWriter::writeFixed(double value, int decimals) {
+    char* first = reserve(64);
+    int length = snprintf(first, 64, "%.*f", decimals, value);
+    if (length > 0) used += min(length, 63);
+}
+
+void OutputWriter::flush() {
+    if (target) {
+        target->append(buffer.data(), used);
+        used = 0;
+        return;
+    }
+    if (used > 0) fwrite(buffer.data(), 1, used, stream);
+    used = 0;
+    fflush(stream);
+}
+
+void writeJsonString(OutputWriter& out, string_view text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            const char* hex = "0123456789abcdef";
+            out << "\\u00" << hex[c >> 4] << hex[c & 15];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+// Presentation of results
+void printColonyInfo(OutputWriter& out, const ColonyInfo& colony) {
+    out << "+++ Ant Colony Information +++\n";
+
+    out << "Number of ants: " << colony.numAnts << '\n';
+
+    vector<RoomId> sortedRooms;
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (colony.roomDeclared[room]) sortedRooms.push_back(room);
+    }
+    sort(sortedRooms.begin(), sortedRooms.end(), [&colony](RoomId a, RoomId b) {
+        return compareRooms(colony.roomName(a), colony.roomName(b));
+    });
+    out << "Rooms and capacities:\n";
+    for (RoomId room : sortedRooms) {
+        out << "  " << colony.roomName(room) << " (capacity " << colony.roomCapacity[room] << ")\n";
+    }
+
+    // List tunnels by room name; a tunnel is printed from whichever end comes first
+    vector<RoomId> byName;
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (!colony.neighbors(room).empty()) byName.push_back(room);
+    }
+    sort(byName.begin(), byName.end(), [&colony](RoomId a, RoomId b) {
+        return colony.roomName(a) < colony.roomName(b);
+    });
+    vector<size_t> rank(colony.roomCount());
+    for (size_t i = 0; i < byName.size(); i++) {
+        rank[byName[i]] = i;
+    }
+
+    out << "Tunnels:\n";
+    for (RoomId room : byName) {
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (rank[neighbor] >= rank[room]) {
+                out << "  " << colony.roomName(room) << " - " << colony.roomName(neighbor) << '\n';
+            }
+        }
+    }
+    out << '\n';
+}
+
+// One step in the usual "fN - from - to" format
+void printStep(OutputWriter& out, const ColonyInfo& colony, size_t step, ArrayView<Move> moves) {
+    out << "+++ Step " << step << " +++\n";
+    for (const Move& move : moves) {
+        out << 'f' << move.ant + 1 << " - " << colony.roomName(move.from) << " - " << colony.roomName(move.to) << '\n';
+    }
+    out << '\n';
+}
+
+void printSchedule(OutputWriter& out, const ColonyInfo& colony, const Schedule& schedule) {
+    for (size_t step = 0; step < schedule.size(); step++) {
+        printStep(out, colony, step + 1, schedule[step]);
+    }
+}
+
+void writeTraceHeader(OutputWriter& out, uint64_t stepCount, uint64_t moveCount) {
+    TraceHeader header = {};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    header.stepCount = stepCount;
+    header.moveCount = moveCount;
+    out.writeBytes(&header, sizeof(header));
+}
+
+// Header followed by one record per move, steps in order
+void writeBinaryTrace(OutputWriter& out, const Schedule& schedule) {
+    uint64_t moveCount = 0;
+    for (const vector<Move>& step : schedule) {
+        moveCount += step.size();
+    }
+    writeTraceHeader(out, schedule.size(), moveCount);
+
+    for (size_t step = 0; step < schedule.size(); step++) {
+        writeTraceStep(out, step + 1, schedule[step]);
+    }
+}
+
+void writeTraceStep(OutputWriter& out, size_t step, ArrayView<Move> moves) {
+    for (const Move& move : moves) {
+        TraceRecord record = {uint32_t(step), uint32_t(move.ant), move.from, move.to};
+        out.writeBytes(&record, sizeof(record));
+    }
+}
+
+// One line per batch ("12 ants - S3 - S4"), or the usual one line per ant when expanded
+void printAggregateStep(OutputWriter& out, const ColonyInfo& colony, size_t step, const AggregateStep& moves, bool expand) {
+    out << "+++ Step " << step << " +++\n";
+    for (const Batch& batch : moves.batches) {
+        string_view from = colony.roomName(batch.from);
+        string_view to = colony.roomName(batch.to);
+        if (expand || batch.count == 1) {
+            for (int k = 0; k < batch.count; k++) {
+                out << 'f' << moves.antOf(batch, k) + 1 << " - " << from << " - " << to << '\n';
+            }
+        } else {
+            out << batch.count << " ants - " << from << " - " << to << '\n';
+        }
+    }
+    out << '\n';
+}
+
+void writeTraceStep(OutputWriter& out, size_t step, const AggregateStep& moves) {
+    for (const Batch& batch : moves.batches) {
+        for (int k = 0; k < batch.count; k++) {
+            TraceRecord record = {uint32_t(step), uint32_t(moves.antOf(batch, k)), batch.from, batch.to};
+            out.writeBytes(&record, sizeof(record));
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "ants.hpp"
+#include "aggregate.hpp"
+
+#include <cstdio>
+
+// Buffered writer for reports and move listings: numbers are formatted in place and
+// nothing is flushed until the buffer fills up or the writer goes away
+class OutputWriter {
+public:
+    explicit OutputWriter(FILE* stream, size_t capacity = 1 << 20);
+    explicit OutputWriter(string& target, size_t capacity = 1 << 16); // Appends to target instead
+    ~OutputWriter();
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    OutputWriter& operator<<(string_view text);
+    OutputWriter& operator<<(char c);
+    OutputWriter& operator<<(int64_t value);
+    OutputWriter& operator<<(int value) { return *this << int64_t(value); }
+    OutputWriter& operator<<(size_t value) { return *this << int64_t(value); }
+    OutputWriter& operator<<(const char* text) { return *this << string_view(text); }
+    OutputWriter& operator<<(const string& text) { return *this << string_view(text); }
+
+    void writeFixed(double value, int decimals);
+    void writeBytes(const void* bytes, size_t size);
+    void flush();
+
+private:
+    FILE* stream = nullptr;
+    string* target = nullptr;
+    vector<char> buffer;
+    size_t used = 0;
+
+    // Make room for size more bytes, flushing what is already there if needed
+    char* reserve(size_t size);
+};
+
+// How the moves of a schedule are written out
+enum TraceFormat {
+    TRACE_TEXT,   // "fN - from - to" lines grouped by step
+    TRACE_BINARY, // Fixed-size TraceRecord entries after a TraceHeader
+    TRACE_NONE    // Summary only
+};
+
+// Binary trace layout, in host byte order
+const char TRACE_MAGIC[8] = {'U', 'V', 'D', 'F', 'T', 'R', 'C', '\0'};
+const uint32_t TRACE_VERSION = 1;
+
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t stepCount; // Both 0 when the trace was streamed: read records up to the end
+    uint64_t moveCount;
+};
+
+struct TraceRecord {
+    uint32_t step; // 1 for the first step
+    uint32_t ant;  // Index of the ant (f1 is 0)
+    RoomId from;
+    RoomId to;
+};
+
+// Quoted and escaped for a JSON document
+void writeJsonString(OutputWriter& out, string_view text);
+
+void printColonyInfo(OutputWriter& out, const ColonyInfo& colony);
+void printSchedule(OutputWriter& out, const ColonyInfo& colony, const Schedule& schedule);
+void writeBinaryTrace(OutputWriter& out, const Schedule& schedule);
+
+// Streaming counterparts, one step at a time (step 1 first)
+void writeTraceHeader(OutputWriter& out, uint64_t stepCount, uint64_t moveCount);
+void printStep(OutputWriter& out, const ColonyInfo& colony, size_t step, ArrayView<Move> moves);
+void writeTraceStep(OutputWriter& out, size_t step, ArrayView<Move> moves);
+void printAggregateStep(OutputWriter& out, const ColonyInfo& colony, size_t step, const AggregateStep& moves, bool expand);
+void writeTraceStep(OutputWriter& out, size_t step, const AggregateStep& moves);
+
+#endif // OUTPUT_H
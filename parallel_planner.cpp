@@ -0,0 +1,274 @@
+#include "parallel_planner.hpp"
+#include "simulation.hpp"
+#include "stats.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+
+namespace {
+
+const size_t MIN_BLOCK = 256;
+const size_t MAX_BLOCK = 65536;
+
+class ParallelPlanner : public StepEngine {
+public:
+    ParallelPlanner(const ColonyInfo& colony, AntTable& ants, size_t threads);
+
+    bool step(vector<Move>& moves) override;
+
+private:
+    const ColonyInfo& colony;
+    AntTable& ants;
+    WorkerTeam team;
+
+    // Neighbors of each room in the order chooseBestNextRoom considers them:
+    // closest to Sd first, ties in adjacency order, rooms that cannot reach Sd left out.
+    // preferences[preferenceOffsets[r] .. preferenceSplit[r]] are the ones closer to Sd than r.
+    vector<uint32_t> preferenceOffsets;
+    vector<uint32_t> preferenceSplit;
+    vector<RoomId> preferences;
+
+    vector<uint32_t> distanceOffsets; // Rooms at distance d are roomsByDistance[distanceOffsets[d] ..]
+    vector<RoomId> roomsByDistance;
+
+    vector<int> occupancy;          // Ants inside each room
+    vector<atomic<int>> remaining;  // Free slots left in the rooms one hop closer than the bucket
+    vector<uint32_t> typeCursor;    // Room -> first forward choice that may still have a slot
+    vector<uint64_t> failedAt;      // Room -> version at which an ant standing there found nowhere to go
+    uint64_t version = 0;           // Bumped whenever a slot is freed
+    size_t blockSize = MIN_BLOCK;
+    bool arrived = false;           // Some ant reached Sd during the step
+    atomic<bool> slotRanOut;
+
+    vector<RoomId> target;          // Per ant of the bucket: room reserved toward Sd, NO_ROOM if none
+
+    vector<int> bucketStart;        // Ants still on their way, by distance: order[bucketStart[d] ..]
+    vector<int> order;
+    vector<int> bucketFill;
+    int64_t stepLimit;
+    int64_t stepsDone = 0;
+
+    bool unlimited(RoomId room) const {
+        return room == DORMITORY || (room == VESTIBULE && colony.roomCapacity[room] > 0);
+    }
+    void buildTables();
+    bool reserveBlock(const AntTable& ants, const int* bucket, size_t begin, size_t end);
+    void reserveInOrder(const AntTable& ants, const int* bucket, size_t begin, size_t end);
+    void planForward(const AntTable& ants, const int* bucket, size_t size, int distance);
+    void finishBucket(AntTable& ants, const int* bucket, size_t size, vector<Move>& moves);
+};
+
+ParallelPlanner::ParallelPlanner(const ColonyInfo& colony, AntTable& ants, size_t threads)
+    : colony(colony), ants(ants), team(threads), occupancy(colony.roomCount(), 0), remaining(colony.roomCount()),
+      typeCursor(colony.roomCount(), 0), failedAt(colony.roomCount(), UINT64_MAX), stepLimit(simulationStepLimit(colony)) {
+    buildTables();
+}
+
+void ParallelPlanner::buildTables() {
+    size_t numRooms = colony.roomCount();
+    preferenceOffsets.assign(numRooms + 1, 0);
+    preferenceSplit.assign(numRooms, 0);
+    int maxDistance = 0;
+    for (RoomId room = 0; room < numRooms; room++) {
+        size_t first = preferences.size();
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (neighbor == DORMITORY || hopsToDormitory(colony, neighbor) != UNREACHABLE) preferences.push_back(neighbor);
+        }
+        stable_sort(preferences.begin() + first, preferences.end(), [this](RoomId a, RoomId b) {
+            return hopsToDormitory(colony, a) < hopsToDormitory(colony, b);
+        });
+        preferenceOffsets[room + 1] = preferences.size();
+
+        int distance = hopsToDormitory(colony, room);
+        size_t split = first;
+        while (split < preferences.size() && hopsToDormitory(colony, preferences[split]) < distance) split++;
+        preferenceSplit[room] = split;
+        if (distance != UNREACHABLE) maxDistance = max(maxDistance, distance);
+    }
+
+    distanceOffsets.assign(maxDistance + 2, 0);
+    for (RoomId room = 0; room < numRooms; room++) {
+        int distance = hopsToDormitory(colony, room);
+        if (distance != UNREACHABLE) distanceOffsets[distance + 1]++;
+    }
+    for (int d = 0; d <= maxDistance; d++) {
+        distanceOffsets[d + 1] += distanceOffsets[d];
+    }
+    roomsByDistance.resize(distanceOffsets.back());
+    vector<uint32_t> fill(distanceOffsets.begin(), distanceOffsets.end() - 1);
+    for (RoomId room = 0; room < numRooms; room++) {
+        int distance = hopsToDormitory(colony, room);
+        if (distance != UNREACHABLE) roomsByDistance[fill[distance]++] = room;
+    }
+}
+
+// Optimistic pass: every ant of the block takes its first forward choice with a free slot,
+// reserved with a compare-and-swap. While no room runs out of slots, the order in which the
+// ants got there cannot matter, so this is what the rank order gives. Otherwise the block is
+// rolled back and redone in order.
+bool ParallelPlanner::reserveBlock(const AntTable& ants, const int* bucket, size_t begin, size_t end) {
+    slotRanOut = false;
+    auto reserve = [&](size_t, size_t first, size_t last) {
+        for (size_t i = begin + first; i < begin + last; i++) {
+            RoomId position = ants.position[bucket[i]];
+            target[i] = NO_ROOM;
+            for (uint32_t k = typeCursor[position]; k < preferenceSplit[position]; k++) {
+                RoomId room = preferences[k];
+                if (unlimited(room)) {
+                    target[i] = room;
+                    break;
+                }
+                int slots = remaining[room].load(memory_order_relaxed);
+                while (slots > 0 && !remaining[room].compare_exchange_weak(slots, slots - 1)) {
+                }
+                if (slots > 0) {
+                    target[i] = room;
+                    if (slots == 1) slotRanOut = true;
+                    break;
+                }
+            }
+        }
+    };
+    // Passed by reference so the std::function wrapping it does not allocate at every block
+    team.parallelFor(end - begin, ref(reserve), 1);
+    if (!slotRanOut) return true;
+
+    for (size_t i = begin; i < end; i++) {
+        if (target[i] != NO_ROOM && !unlimited(target[i])) remaining[target[i]]++;
+    }
+    return false;
+}
+
+// Rank order, one ant after the other. Ants in the same room share their list of choices and
+// rooms only fill up, so each room keeps a cursor past the choices already full.
+void ParallelPlanner::reserveInOrder(const AntTable& ants, const int* bucket, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        RoomId position = ants.position[bucket[i]];
+        uint32_t& k = typeCursor[position];
+        uint32_t last = preferenceSplit[position];
+        while (k < last && !unlimited(preferences[k]) && remaining[preferences[k]] == 0) k++;
+        if (k == last) {
+            target[i] = NO_ROOM;
+            continue;
+        }
+        target[i] = preferences[k];
+        if (!unlimited(target[i])) remaining[target[i]]--;
+    }
+}
+
+// Moves toward Sd. Ants of a bucket never leave a room closer to Sd than theirs, so those rooms
+// only fill up while the bucket is planned and each ant gets the first of them that still has a
+// slot when its turn comes. Blocks of ants are reserved in parallel when they do not compete for
+// the last slot of a room, and the block size adapts to how often they do.
+void ParallelPlanner::planForward(const AntTable& ants, const int* bucket, size_t size, int distance) {
+    target.assign(size, NO_ROOM);
+    if (distance == 0) return;
+    for (uint32_t r = distanceOffsets[distance - 1]; r < distanceOffsets[distance]; r++) {
+        RoomId room = roomsByDistance[r];
+        remaining[room] = colony.roomCapacity[room] - occupancy[room];
+    }
+    for (uint32_t r = distanceOffsets[distance]; r < distanceOffsets[distance + 1]; r++) {
+        RoomId room = roomsByDistance[r];
+        typeCursor[room] = preferenceOffsets[room];
+    }
+
+    size_t begin = 0;
+    while (begin < size) {
+        size_t end = min(size, begin + blockSize);
+        if (team.size() > 1 && end - begin >= MIN_BLOCK && reserveBlock(ants, bucket, begin, end)) {
+            blockSize = min(blockSize * 2, MAX_BLOCK);
+        } else {
+            reserveInOrder(ants, bucket, begin, end);
+            blockSize = max(blockSize / 2, MIN_BLOCK);
+        }
+        begin = end;
+    }
+}
+
+// Apply the bucket in rank order. Ants with no room closer to Sd try the others here, one after
+// the other, since a room at the same distance can be freed by any ant ranked before them.
+// Ants standing in the same room have the same options, so once one of them is stuck the
+// next ones are too until a slot is freed somewhere.
+void ParallelPlanner::finishBucket(AntTable& ants, const int* bucket, size_t size, vector<Move>& moves) {
+    for (size_t i = 0; i < size; i++) {
+        int ant = bucket[i];
+        RoomId from = ants.position[ant];
+        RoomId to = target[i];
+        if (to == NO_ROOM && failedAt[from] != version) {
+            for (uint32_t k = preferenceSplit[from]; k < preferenceOffsets[from + 1]; k++) {
+                if (occupancy[preferences[k]] < colony.roomCapacity[preferences[k]]) {
+                    to = preferences[k];
+                    break;
+                }
+            }
+            if (to == NO_ROOM) failedAt[from] = version;
+        }
+        if (to == NO_ROOM) {
+            STAT_INC(STAT_MOVES_REJECTED);
+            continue;
+        }
+        STAT_INC(STAT_MOVES_PLANNED);
+
+        if (from != VESTIBULE && from != DORMITORY) {
+            occupancy[from]--;
+            version++;
+        }
+        if (to != VESTIBULE && to != DORMITORY) occupancy[to]++;
+        ants.moveTo(ant, to, stepsDone + 1);
+        arrived = arrived || to == DORMITORY;
+        moves.push_back({ant, from, to});
+    }
+}
+
+bool ParallelPlanner::step(vector<Move>& moves) {
+    moves.clear();
+    if (stepsDone >= stepLimit) return false;
+    STAT_STEP_TIMER();
+    int maxDistance = distanceOffsets.size() - 2;
+
+    // Counting sort of the ants still on their way by distance, index order inside a bucket.
+    // Ants that cannot reach Sd cannot move either, they are left out.
+    if (ants.active.empty()) return false;
+    arrived = false;
+    bucketStart.assign(maxDistance + 2, 0);
+    for (int ant : ants.active) {
+        int distance = hopsToDormitory(colony, ants.position[ant]);
+        if (distance != UNREACHABLE) bucketStart[distance + 1]++;
+    }
+    for (size_t b = 1; b < bucketStart.size(); b++) {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+    order.resize(bucketStart.back());
+    bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (int ant : ants.active) {
+        int distance = hopsToDormitory(colony, ants.position[ant]);
+        if (distance != UNREACHABLE) order[bucketFill[distance]++] = ant;
+    }
+
+    for (int distance = 0; distance <= maxDistance; distance++) {
+        const int* bucket = order.data() + bucketStart[distance];
+        size_t size = bucketStart[distance + 1] - bucketStart[distance];
+        if (size == 0) continue;
+        planForward(ants, bucket, size, distance);
+        finishBucket(ants, bucket, size, moves);
+    }
+
+    if (arrived) ants.compact();
+    if (moves.empty()) return false;
+    stepsDone++;
+    return true;
+}
+
+} // namespace
+
+unique_ptr<StepEngine> makeParallelGreedyEngine(const ColonyInfo& colony, AntTable& ants, size_t threads) {
+    return make_unique<ParallelPlanner>(colony, ants, threads);
+}
+
+void runParallelGreedySimulation(const ColonyInfo& colony, AntTable& ants, Schedule& schedule, size_t threads) {
+    ParallelPlanner planner(colony, ants, threads);
+    vector<Move> moves;
+    while (planner.step(moves)) {
+        schedule.push_back(moves);
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef PARALLEL_PLANNER_H
+#define PARALLEL_PLANNER_H
+
+#include "ants.hpp"
+
+// Greedy engine with the move planning of each step spread over several threads.
+// Ants are planned one distance bucket at a time, closest to Sd first; inside a bucket the
+// moves toward Sd are reserved in parallel and the plan is the same as the bfs strategy,
+// whatever the thread count.
+class StepEngine;
+
+// One step at a time (the engine keeps references to colony and ants), or every step at once
+unique_ptr<StepEngine> makeParallelGreedyEngine(const ColonyInfo& colony, AntTable& ants, size_t threads);
+void runParallelGreedySimulation(const ColonyInfo& colony, AntTable& ants, Schedule& schedule, size_t threads);
+
+#endif // PARALLEL_PLANNER_H
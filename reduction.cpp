@@ -0,0 +1,291 @@
+#include "reduction.hpp"
+#include "stats.hpp"
+
+namespace {
+
+// Iterative Hopcroft-Tarjan depth-first search for the biconnected blocks of the rooms marked
+// inside (all of them without a mask). Several searches can share it, one per root, to cover a
+// graph that is not connected.
+class BlockSearch {
+public:
+    BlockSearch(const ColonyInfo& colony, const vector<char>* inside);
+
+    // Blocks reached from root, each one handed to onBlock(rooms, throughExtra) as it closes. With
+    // extraTunnel the search starts at Sv and first takes an extra Sv - Sd tunnel, and throughExtra
+    // tells the block holding it. A root without any neighbor is a block of its own.
+    template <typename OnBlock>
+    void run(RoomId root, bool extraTunnel, OnBlock onBlock);
+
+    bool visited(RoomId room) const { return order[room] != 0; }
+
+    vector<char> articulation; // Rooms whose removal splits what the searches reached
+
+private:
+    const ColonyInfo& colony;
+    const vector<char>* inside;
+    vector<uint32_t> order;  // Discovery rank, 0 until visited
+    vector<uint32_t> low;    // Lowest rank reachable from the subtree by one back tunnel
+    vector<RoomId> parent;
+    vector<uint32_t> cursor;
+    vector<uint32_t> seen;   // Block count when a room was last added to a block
+    uint32_t numVisited = 0;
+    uint32_t numBlocks = 0;
+
+    bool enters(RoomId room) const { return inside == nullptr || (*inside)[room]; }
+};
+
+BlockSearch::BlockSearch(const ColonyInfo& colony, const vector<char>* inside)
+    : articulation(colony.roomCount(), 0), colony(colony), inside(inside),
+      order(colony.roomCount(), 0), low(colony.roomCount(), 0), parent(colony.roomCount(), NO_ROOM),
+      cursor(colony.roomCount(), 0), seen(colony.roomCount(), 0) {}
+
+template <typename OnBlock>
+void BlockSearch::run(RoomId root, bool extraTunnel, OnBlock onBlock) {
+    vector<RoomId> path;                  // Rooms of the search still being explored
+    vector<pair<RoomId, RoomId>> tunnels; // Tunnels of the blocks not closed yet
+    vector<RoomId> rooms;
+    int rootChildren = 0;
+
+    auto visit = [&](RoomId room, RoomId from) {
+        order[room] = low[room] = ++numVisited;
+        parent[room] = from;
+        cursor[room] = colony.tunnelOffsets[room];
+        path.push_back(room);
+    };
+    visit(root, NO_ROOM);
+    if (extraTunnel) {
+        tunnels.push_back({VESTIBULE, DORMITORY});
+        visit(DORMITORY, VESTIBULE);
+        rootChildren++;
+    }
+
+    while (!path.empty()) {
+        RoomId room = path.back();
+        if (cursor[room] < colony.tunnelOffsets[room + 1]) {
+            RoomId next = colony.tunnels[cursor[room]++];
+            if (!enters(next)) continue;
+            if (order[next] == 0) {
+                tunnels.push_back({room, next});
+                if (room == root) rootChildren++;
+                visit(next, room);
+            } else if (next != parent[room] && order[next] < order[room]) {
+                tunnels.push_back({room, next});
+                low[room] = min(low[room], order[next]);
+            }
+            continue;
+        }
+
+        path.pop_back();
+        RoomId above = parent[room];
+        if (above == NO_ROOM) break;
+        low[above] = min(low[above], low[room]);
+        if (low[room] < order[above]) continue;
+
+        // Nothing below room goes higher than above: the tunnels since above -> room form a block
+        if (above != root) articulation[above] = 1;
+        numBlocks++;
+        rooms.clear();
+        auto add = [&](RoomId member) {
+            if (seen[member] == numBlocks) return;
+            seen[member] = numBlocks;
+            rooms.push_back(member);
+        };
+        pair<RoomId, RoomId> tunnel;
+        do {
+            tunnel = tunnels.back();
+            tunnels.pop_back();
+            add(tunnel.first);
+            add(tunnel.second);
+        } while (tunnel.first != above || tunnel.second != room);
+        onBlock(rooms, extraTunnel && above == VESTIBULE && room == DORMITORY);
+    }
+
+    if (rootChildren >= 2) articulation[root] = 1;
+    if (rootChildren == 0) {
+        rooms.assign(1, root);
+        onBlock(rooms, false);
+    }
+}
+
+// Rooms on some simple Sv -> Sd path. With an extra Sv - Sd tunnel they are exactly the rooms of
+// the biconnected block holding it: a cycle through that tunnel and a room is such a path.
+void markUsefulRooms(const ColonyInfo& colony, vector<char>& useful) {
+    useful.assign(colony.roomCount(), 0);
+    BlockSearch search(colony, nullptr);
+    search.run(VESTIBULE, true, [&](const vector<RoomId>& rooms, bool throughExtra) {
+        if (!throughExtra) return;
+        for (RoomId room : rooms) useful[room] = 1;
+    });
+}
+
+} // namespace
+
+void reduceColony(const ColonyInfo& colony, ColonyReduction& reduction) {
+    reduction = ColonyReduction();
+    markUsefulRooms(colony, reduction.useful);
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (!reduction.useful[room]) continue;
+        reduction.usefulRooms++;
+        for (RoomId neighbor : colony.neighbors(room)) reduction.usefulTunnels += reduction.useful[neighbor];
+    }
+    STAT_ADD(STAT_ROOMS_PRUNED, colony.roomCount() - reduction.usefulRooms);
+}
+
+// Maximal chains of useful rooms with two useful neighbors, each one found from its lower end
+void findCorridors(const ColonyInfo& colony, ColonyReduction& reduction) {
+    const vector<char>& useful = reduction.useful;
+    reduction.corridors.clear();
+    reduction.corridorRooms = 0;
+    size_t numRooms = colony.roomCount();
+    vector<int> degree(numRooms, 0);
+    for (RoomId room = 0; room < numRooms; room++) {
+        if (!useful[room]) continue;
+        for (RoomId neighbor : colony.neighbors(room)) degree[room] += useful[neighbor];
+    }
+    auto inside = [&](RoomId room) {
+        return useful[room] && degree[room] == 2 && room != VESTIBULE && room != DORMITORY;
+    };
+
+    for (RoomId end = 0; end < numRooms; end++) {
+        if (!useful[end] || inside(end)) continue;
+        for (RoomId first : colony.neighbors(end)) {
+            if (!inside(first)) continue;
+
+            Corridor corridor{end, NO_ROOM, {}, INT_MAX};
+            RoomId previous = end;
+            RoomId room = first;
+            while (inside(room)) {
+                corridor.rooms.push_back(room);
+                corridor.capacity = min(corridor.capacity, colony.roomCapacity[room]);
+                for (RoomId next : colony.neighbors(room)) {
+                    if (useful[next] && next != previous) {
+                        previous = room;
+                        room = next;
+                        break;
+                    }
+                }
+            }
+            corridor.to = room;
+            if (end < room || (end == room && corridor.rooms.front() < corridor.rooms.back())) {
+                reduction.corridorRooms += corridor.rooms.size();
+                reduction.corridors.push_back(move(corridor));
+            }
+        }
+    }
+    STAT_ADD(STAT_CORRIDOR_ROOMS, reduction.corridorRooms);
+}
+
+void findBlocks(const ColonyInfo& colony, const vector<char>& inside, BlockStructure& structure) {
+    structure = BlockStructure();
+    BlockSearch search(colony, &inside);
+    auto addBlock = [&](const vector<RoomId>& rooms, bool) {
+        structure.blocks.push_back(rooms);
+        sort(structure.blocks.back().begin(), structure.blocks.back().end());
+    };
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (inside[room] && !search.visited(room)) search.run(room, false, addBlock);
+    }
+    structure.articulation = move(search.articulation);
+}
+
+void findSegments(const ColonyInfo& colony, const ColonyReduction& reduction, vector<ColonySegment>& segments) {
+    segments.clear();
+    if (colony.dormitoryDistance[VESTIBULE] == UNREACHABLE) return;
+    BlockStructure structure;
+    findBlocks(colony, reduction.useful, structure);
+
+    // Blocks each separator belongs to (two of them, since the blocks form a chain)
+    vector<vector<uint32_t>> blocksOf(colony.roomCount());
+    uint32_t current = 0;
+    for (uint32_t b = 0; b < structure.blocks.size(); b++) {
+        for (RoomId room : structure.blocks[b]) {
+            if (structure.articulation[room]) blocksOf[room].push_back(b);
+            if (room == VESTIBULE) current = b;
+        }
+    }
+
+    // Walk the chain from the block of Sv, leaving each block by its other separator (or Sd)
+    RoomId entry = VESTIBULE;
+    while (entry != DORMITORY) {
+        const vector<RoomId>& rooms = structure.blocks[current];
+        RoomId exit = NO_ROOM;
+        for (RoomId room : rooms) {
+            if (room == DORMITORY) {
+                exit = room;
+                break;
+            }
+            if (room != entry && structure.articulation[room]) exit = room;
+        }
+        segments.push_back({entry, exit, rooms});
+        if (exit == DORMITORY) break;
+        current = blocksOf[exit][0] == current ? blocksOf[exit][1] : blocksOf[exit][0];
+        entry = exit;
+    }
+}
+
+ColonyInfo segmentColony(const ColonyInfo& colony, const ColonySegment& segment, vector<RoomId>& rooms) {
+    ColonyInfo part;
+    part.numAnts = colony.numAnts;
+    part.sourceBytes = 0;
+    part.storage = make_shared<ColonyStorage>();
+    part.storage->nameOffsets.push_back(0);
+
+    // Sv and Sd come first as in any colony; past the first segment the entry is a room of its own
+    // behind a new Sv, as it keeps its capacity
+    vector<RoomId> partId(colony.roomCount(), NO_ROOM);
+    rooms.clear();
+    auto copyRoom = [&](RoomId room, string_view name) {
+        RoomId id = addRoom(part, name);
+        part.storage->roomCapacity[id] = colony.roomCapacity[room];
+        part.storage->roomDeclared[id] = colony.roomDeclared[room];
+        partId[room] = id;
+        rooms.push_back(room);
+    };
+    if (segment.entry == VESTIBULE) {
+        copyRoom(VESTIBULE, "Sv");
+    } else {
+        addRoom(part, "Sv");
+        rooms.push_back(NO_ROOM);
+    }
+    copyRoom(segment.exit, "Sd");
+    for (RoomId room : segment.rooms) {
+        if (partId[room] == NO_ROOM) copyRoom(room, colony.roomName(room));
+    }
+    if (segment.entry != VESTIBULE) addTunnel(part, VESTIBULE, partId[segment.entry]);
+
+    for (RoomId room : segment.rooms) {
+        for (RoomId neighbor : colony.neighbors(room)) {
+            if (room < neighbor && partId[neighbor] != NO_ROOM) addTunnel(part, partId[room], partId[neighbor]);
+        }
+    }
+    buildTunnelGraph(part);
+    return part;
+}
+
+ColonyInfo prunedColony(const ColonyInfo& colony, const ColonyReduction& reduction) {
+    shared_ptr<ColonyStorage> storage = make_shared<ColonyStorage>();
+    storage->shared = colony.storage;
+    storage->tunnelOffsets.reserve(colony.roomCount() + 1);
+    storage->tunnels.reserve(reduction.usefulTunnels);
+    storage->tunnelOffsets.push_back(0);
+    for (RoomId room = 0; room < colony.roomCount(); room++) {
+        if (reduction.useful[room]) {
+            for (RoomId neighbor : colony.neighbors(room)) {
+                if (reduction.useful[neighbor]) storage->tunnels.push_back(neighbor);
+            }
+        }
+        storage->tunnelOffsets.push_back(storage->tunnels.size());
+    }
+
+    ColonyInfo pruned = colony;
+    pruned.storage = storage;
+    pruned.tunnelOffsets = storage->tunnelOffsets;
+    pruned.tunnels = storage->tunnels;
+    return pruned;
+}
+
+ColonyInfo withoutDeadRooms(const ColonyInfo& colony) {
+    ColonyReduction reduction;
+    reduceColony(colony, reduction);
+    return prunedColony(colony, reduction);
+}
@@ -0,0 +1,67 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include "ants.hpp"
+
+// Chain of rooms with exactly two useful neighbors between two other useful rooms: ants can only
+// go through it one room after the other
+struct Corridor {
+    RoomId from;          // Useful room at one end (Sv, Sd or a room with another degree)
+    RoomId to;            // Same at the other end
+    vector<RoomId> rooms; // Rooms inside, from the from side
+    int capacity;         // Smallest capacity inside: ants entering per step
+
+    int length() const { return rooms.size() + 1; } // Tunnels from one end to the other
+};
+
+// What of a colony any plan can use: the rooms lying on some simple Sv -> Sd path (the others are
+// unreachable, cannot reach Sd, or hang off a single room like a dead end) and, once
+// findCorridors ran, the corridors between them
+struct ColonyReduction {
+    vector<char> useful; // Room id -> on a simple Sv -> Sd path
+    size_t usefulRooms = 0;
+    size_t usefulTunnels = 0; // CSR entries between useful rooms (each tunnel twice)
+    vector<Corridor> corridors;
+    size_t corridorRooms = 0;
+};
+
+void reduceColony(const ColonyInfo& colony, ColonyReduction& reduction);
+
+// Corridors between the useful rooms of reduction, for the planners that take each one as a
+// single tunnel (the route planner of routes.cpp)
+void findCorridors(const ColonyInfo& colony, ColonyReduction& reduction);
+
+// The colony with only the tunnels between useful rooms. Room ids, names, capacities and
+// distances to Sd are those of colony (shared with it), so moves planned on it print the same.
+ColonyInfo prunedColony(const ColonyInfo& colony, const ColonyReduction& reduction);
+
+// prunedColony of the reduction of colony, for the engines that look at every neighbor of the
+// rooms they go through (greedy and aggregate)
+ColonyInfo withoutDeadRooms(const ColonyInfo& colony);
+
+// Biconnected blocks of the rooms marked inside: the largest groups of rooms that no single room
+// can split. A room without any tunnel inside is a block of its own.
+struct BlockStructure {
+    vector<vector<RoomId>> blocks;
+    vector<char> articulation; // Room id -> in several blocks (its removal splits them apart)
+};
+
+void findBlocks(const ColonyInfo& colony, const vector<char>& inside, BlockStructure& structure);
+
+// Stretch of the useful rooms between two rooms that every ant goes through
+struct ColonySegment {
+    RoomId entry;         // Sv or the separator ants come in by
+    RoomId exit;          // Sd or the separator ants leave by
+    vector<RoomId> rooms; // All of its rooms, entry and exit included
+};
+
+// The blocks of the useful rooms form a chain from Sv to Sd, joined by separators (their
+// articulation points): one segment per block, Sv first. Empty when Sd is out of reach.
+void findSegments(const ColonyInfo& colony, const ColonyReduction& reduction, vector<ColonySegment>& segments);
+
+// A segment as a colony of its own, for as many ants as colony: its exit is Sd, and past the first
+// segment a new Sv leads to the entry, which keeps its capacity. rooms maps its room ids back to
+// those of colony (NO_ROOM for that new Sv).
+ColonyInfo segmentColony(const ColonyInfo& colony, const ColonySegment& segment, vector<RoomId>& rooms);
+
+#endif // REDUCTION_H
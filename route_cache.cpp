@@ -0,0 +1,259 @@
+#include "route_cache.hpp"
+#include "mapped_file.hpp"
+#include "routes.hpp"
+#include "stats.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+
+namespace {
+
+const char ROUTE_CACHE_MAGIC[8] = {'U', 'V', 'D', 'F', 'R', 'T', 'E', '\0'};
+const uint32_t ROUTE_CACHE_VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// Rooms in a route cache file are numbered by the rank of their name, the same whatever the
+// order they were declared in
+struct RouteCacheHeader {
+    char magic[8];        // "UVDFRTE" + NUL
+    uint32_t version;
+    uint32_t byteOrder;   // 0x01020304 as written by the writing machine
+    uint64_t topology;    // topologyHash of the colony
+    uint64_t roomCount;
+    uint64_t tunnelCount; // CSR entries
+    int64_t antLimit;
+    int64_t frontier;
+    uint64_t pathCount;   // Followed by uint64_t pathOffsets[pathCount + 1], uint32_t pathRooms[]
+    uint64_t levelCount;  // Then uint64_t levelOffsets[levelCount + 1], LevelEntry levelEntries[]
+};
+
+struct LevelEntry {
+    uint32_t path;
+    uint32_t unused;
+    int64_t width;
+};
+
+class TopologyHasher {
+public:
+    void add(uint64_t value) {
+        state = (state ^ value) * 0x9E3779B97F4A7C15ull;
+        state ^= state >> 31;
+    }
+
+    void add(string_view text) {
+        add(text.size());
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            uint64_t word;
+            memcpy(&word, text.data() + i, 8);
+            add(word);
+        }
+        uint64_t tail = 0;
+        memcpy(&tail, text.data() + i, text.size() - i);
+        add(tail);
+    }
+
+    uint64_t value() const { return state; }
+
+private:
+    uint64_t state = 0x243F6A8885A308D3ull;
+};
+
+// Rooms sorted by name (byRank) and the hash of the colony in that order
+uint64_t hashTopology(const ColonyInfo& colony, vector<RoomId>& byRank) {
+    size_t numRooms = colony.roomCount();
+    byRank.resize(numRooms);
+    for (RoomId room = 0; room < numRooms; room++) byRank[room] = room;
+    sort(byRank.begin(), byRank.end(), [&](RoomId a, RoomId b) { return colony.roomName(a) < colony.roomName(b); });
+    vector<uint32_t> rankOf(numRooms);
+    for (uint32_t rank = 0; rank < numRooms; rank++) rankOf[byRank[rank]] = rank;
+
+    TopologyHasher hasher;
+    hasher.add(numRooms);
+    hasher.add(colony.tunnels.size());
+    for (RoomId room : byRank) {
+        hasher.add(colony.roomName(room));
+        hasher.add(uint64_t(int64_t(colony.roomCapacity[room])));
+    }
+    vector<uint32_t> neighbors;
+    for (uint32_t rank = 0; rank < numRooms; rank++) {
+        neighbors.clear();
+        for (RoomId neighbor : colony.neighbors(byRank[rank])) neighbors.push_back(rankOf[neighbor]);
+        sort(neighbors.begin(), neighbors.end());
+        hasher.add(neighbors.size());
+        for (uint32_t neighbor : neighbors) hasher.add(neighbor);
+    }
+    return hasher.value();
+}
+
+string routeCacheFile(const string& directory, uint64_t topology) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.routes", static_cast<unsigned long long>(topology));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Sequential reads out of a cache file, failing past its end
+class CacheReader {
+public:
+    CacheReader(const char* data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    bool read(T* items, uint64_t count) {
+        if (count > (size - position) / sizeof(T)) return false;
+        memcpy(items, data + position, count * sizeof(T));
+        position += count * sizeof(T);
+        return true;
+    }
+
+    bool atEnd() const { return position == size; }
+
+private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+};
+
+// Offsets of count rows, each one at least minimum long, ending at the end of the array
+bool validRows(const vector<uint64_t>& offsets, uint64_t minimum) {
+    if (offsets.front() != 0) return false;
+    for (size_t i = 1; i < offsets.size(); i++) {
+        if (offsets[i] < offsets[i - 1] + minimum) return false;
+    }
+    return true;
+}
+
+// Ladder stored for this colony, false when there is none (or not a usable one)
+bool readRouteLadder(const string& filename, const ColonyInfo& colony, uint64_t topology, const vector<RoomId>& byRank,
+                     RouteLadder& ladder) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+    CacheReader reader(file.data(), file.size());
+
+    RouteCacheHeader header;
+    if (!reader.read(&header, 1) || memcmp(header.magic, ROUTE_CACHE_MAGIC, sizeof(ROUTE_CACHE_MAGIC)) != 0 ||
+        header.version != ROUTE_CACHE_VERSION || header.byteOrder != BYTE_ORDER_MARK || header.topology != topology ||
+        header.roomCount != colony.roomCount() || header.tunnelCount != colony.tunnels.size() ||
+        header.pathCount >= UINT32_MAX || header.levelCount == 0) {
+        return false;
+    }
+
+    vector<uint64_t> pathOffsets(header.pathCount + 1);
+    vector<uint64_t> levelOffsets(header.levelCount + 1);
+    if (!reader.read(pathOffsets.data(), pathOffsets.size()) || !validRows(pathOffsets, 2)) return false;
+    vector<uint32_t> pathRooms(pathOffsets.back());
+    if (!reader.read(pathRooms.data(), pathRooms.size())) return false;
+    if (!reader.read(levelOffsets.data(), levelOffsets.size()) || !validRows(levelOffsets, 1)) return false;
+    vector<LevelEntry> entries(levelOffsets.back());
+    if (!reader.read(entries.data(), entries.size()) || !reader.atEnd()) return false;
+
+    ladder = RouteLadder();
+    ladder.antLimit = header.antLimit;
+    ladder.frontier = header.frontier;
+    ladder.paths.resize(header.pathCount);
+    for (size_t p = 0; p < header.pathCount; p++) {
+        vector<RoomId>& path = ladder.paths[p];
+        for (uint64_t i = pathOffsets[p]; i < pathOffsets[p + 1]; i++) {
+            if (pathRooms[i] >= byRank.size()) return false;
+            path.push_back(byRank[pathRooms[i]]);
+        }
+        if (path.front() != VESTIBULE || path.back() != DORMITORY) return false;
+    }
+    ladder.levels.resize(header.levelCount);
+    for (size_t l = 0; l < header.levelCount; l++) {
+        for (uint64_t i = levelOffsets[l]; i < levelOffsets[l + 1]; i++) {
+            if (entries[i].path >= header.pathCount || entries[i].width <= 0) return false;
+            ladder.levels[l].push_back({entries[i].path, entries[i].width});
+        }
+    }
+    return true;
+}
+
+// Written next to its final name and renamed, so that readers only ever see whole files
+bool writeRouteLadder(const string& filename, const ColonyInfo& colony, uint64_t topology, const vector<RoomId>& byRank,
+                      const RouteLadder& ladder) {
+    static atomic<unsigned> writes(0);
+    vector<uint32_t> rankOf(byRank.size());
+    for (uint32_t rank = 0; rank < byRank.size(); rank++) rankOf[byRank[rank]] = rank;
+
+    RouteCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROUTE_CACHE_MAGIC, sizeof(ROUTE_CACHE_MAGIC));
+    header.version = ROUTE_CACHE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.topology = topology;
+    header.roomCount = colony.roomCount();
+    header.tunnelCount = colony.tunnels.size();
+    header.antLimit = ladder.antLimit;
+    header.frontier = ladder.frontier;
+    header.pathCount = ladder.paths.size();
+    header.levelCount = ladder.levels.size();
+
+    vector<uint64_t> pathOffsets(1, 0);
+    vector<uint32_t> pathRooms;
+    for (const vector<RoomId>& path : ladder.paths) {
+        for (RoomId room : path) pathRooms.push_back(rankOf[room]);
+        pathOffsets.push_back(pathRooms.size());
+    }
+    vector<uint64_t> levelOffsets(1, 0);
+    vector<LevelEntry> entries;
+    for (const vector<pair<uint32_t, int64_t>>& level : ladder.levels) {
+        for (const pair<uint32_t, int64_t>& route : level) entries.push_back({route.first, 0, route.second});
+        levelOffsets.push_back(entries.size());
+    }
+
+    string temporary = filename + ".tmp" + to_string(getpid()) + "." + to_string(writes++);
+    ofstream out(temporary, ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(pathOffsets.data()), pathOffsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(pathRooms.data()), pathRooms.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(levelOffsets.data()), levelOffsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(LevelEntry));
+    out.close();
+
+    error_code error;
+    if (out) std::filesystem::rename(temporary, filename, error);
+    if (!out || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t topologyHash(const ColonyInfo& colony) {
+    vector<RoomId> byRank;
+    return hashTopology(colony, byRank);
+}
+
+bool solveWithRouteCache(const ColonyInfo& colony, const string& directory, Schedule& schedule, int64_t lowerBound) {
+    if (colony.numAnts <= 0) return solveWithRoutes(colony, schedule, lowerBound);
+
+    vector<RoomId> byRank;
+    uint64_t topology = hashTopology(colony, byRank);
+    string filename = routeCacheFile(directory, topology);
+
+    RouteLadder ladder;
+    vector<Route> routes;
+    if (readRouteLadder(filename, colony, topology, byRank, ladder) &&
+        pickLadderRoutes(ladder, colony.numAnts, lowerBound, routes)) {
+        STAT_INC(STAT_ROUTE_CACHE_HITS);
+    } else {
+        STAT_INC(STAT_ROUTE_CACHE_MISSES);
+        if (!planRouteLadder(colony, ladder, lowerBound)) return false;
+
+        // The ladder holds every route set planRoutes saw, its best one is the plan for this count
+        pickLadderRoutes(ladder, colony.numAnts, INT64_MAX, routes);
+
+        error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (!writeRouteLadder(filename, colony, topology, byRank, ladder)) {
+            cerr << "Warning: unable to write route cache " << filename << endl;
+        }
+    }
+
+    scheduleOnRoutes(routes, colony.numAnts, schedule);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include "ants.hpp"
+
+// On-disk cache of the paths solver (--route-cache=DIR). The route ladder of a colony (routes.hpp)
+// is stored under a hash of its rooms, capacities and tunnels that ignores the order of the lines
+// and the number of ants, so a colony solved once is solved again for another f= by picking a
+// route set in closed form. A count the ladder cannot answer for sure is planned again and
+// replaces it. Hits and misses are counted in STAT_ROUTE_CACHE_HITS / STAT_ROUTE_CACHE_MISSES.
+
+// Hash of the rooms (names and capacities) and tunnels, the same for any order of the lines
+uint64_t topologyHash(const ColonyInfo& colony);
+
+// solveWithRoutes, going through the cache in directory (created if needed). A cache that
+// cannot be read or written only costs the planning, it is never an error.
+bool solveWithRouteCache(const ColonyInfo& colony, const string& directory, Schedule& schedule, int64_t lowerBound = 0);
+
+#endif // ROUTE_CACHE_H
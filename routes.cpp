@@ -0,0 +1,412 @@
+#include "routes.hpp"
+#include "bounds.hpp"
+#include "flow.hpp"
+#include "reduction.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+// Room graph as a flow network: every room is an in node and an out node joined by its capacity,
+// every tunnel an uncapacitated arc of cost 1 in each direction. Only the useful rooms are in it
+// (reduction.hpp), and a corridor is a single arc each way whose capacity is its narrowest room
+// and whose cost is its length: routes in single file through it never wait inside, so that is
+// all a route set sees of it. Routes are spread back into every room they go through.
+class RoomNetwork {
+public:
+    RoomNetwork(const ColonyInfo& colony) : colony(colony) {
+        size_t numRooms = colony.roomCount();
+        reduceColony(colony, reduction);
+        findCorridors(colony, reduction);
+        vector<uint32_t> corridorOf(numRooms, UINT32_MAX);
+        for (uint32_t k = 0; k < reduction.corridors.size(); k++) {
+            for (RoomId room : reduction.corridors[k].rooms) corridorOf[room] = k;
+        }
+
+        for (RoomId room = 0; room < numRooms; room++) {
+            network.addNode(); // in node = 2 * room
+            network.addNode(); // out node = 2 * room + 1
+            if (!reduction.useful[room] || corridorOf[room] != UINT32_MAX) continue;
+            int64_t capacity = max(colony.roomCapacity[room], 0);
+            if (room == VESTIBULE || room == DORMITORY) capacity = INFINITE_CAPACITY;
+            network.addEdge(2 * room, 2 * room + 1, capacity, 0);
+        }
+
+        // Arcs follow the CSR layout so flows can be read back per tunnel, a corridor standing
+        // in for the tunnel into its first room
+        arcOffsets.push_back(0);
+        for (RoomId room = 0; room < numRooms; room++) {
+            bool leaves = reduction.useful[room] && corridorOf[room] == UINT32_MAX && room != DORMITORY;
+            for (RoomId neighbor : colony.neighbors(room)) {
+                if (!leaves || !reduction.useful[neighbor] || neighbor == VESTIBULE) continue;
+                uint32_t k = corridorOf[neighbor];
+                if (k == UINT32_MAX) {
+                    arcs.push_back({network.addEdge(2 * room + 1, 2 * neighbor, INFINITE_CAPACITY, 1), neighbor, UINT32_MAX, false});
+                    continue;
+                }
+                const Corridor& corridor = reduction.corridors[k];
+                if (corridor.from == corridor.to) continue; // Leads back where it started
+                bool forward = corridor.from == room && corridor.rooms.front() == neighbor;
+                if (!forward && (corridor.to != room || corridor.rooms.back() != neighbor)) continue;
+                RoomId end = forward ? corridor.to : corridor.from;
+                if (end == VESTIBULE) continue;
+                int edge = network.addEdge(2 * room + 1, 2 * end, max(corridor.capacity, 0), corridor.length());
+                arcs.push_back({edge, end, k, !forward});
+            }
+            arcOffsets.push_back(arcs.size());
+        }
+    }
+
+    bool augment(int64_t limit, int64_t& pushed, int64_t& pathCost) {
+        return network.augmentShortestPath(2 * VESTIBULE + 1, 2 * DORMITORY, limit, pushed, pathCost);
+    }
+
+    // Split the current flow into Sv -> Sd routes, identical routes merged into a wider one
+    void decompose(vector<Route>& routes) const {
+        size_t numRooms = colony.roomCount();
+
+        vector<int64_t> remaining(arcs.size(), 0);
+        for (size_t i = 0; i < arcs.size(); i++) remaining[i] = network.flowOn(arcs[i].edge);
+        vector<uint32_t> cursor(arcOffsets.begin(), arcOffsets.end() - 1);
+        vector<int> pathIndex(numRooms, -1);
+
+        map<vector<RoomId>, int64_t> widths;
+        vector<RoomId> rooms;
+        vector<uint32_t> taken;
+        vector<RoomId> expanded;
+        while (true) {
+            rooms.assign(1, VESTIBULE);
+            taken.clear();
+            pathIndex[VESTIBULE] = 0;
+            RoomId room = VESTIBULE;
+
+            while (room != DORMITORY) {
+                while (cursor[room] < arcOffsets[room + 1] && remaining[cursor[room]] == 0) cursor[room]++;
+                if (cursor[room] == arcOffsets[room + 1]) break;
+
+                uint32_t arc = cursor[room];
+                RoomId next = arcs[arc].to;
+                taken.push_back(arc);
+
+                if (pathIndex[next] >= 0) {
+                    // Flow going around in a circle carries no ant anywhere: drop the cycle
+                    size_t cycleStart = pathIndex[next];
+                    int64_t cycleFlow = INFINITE_CAPACITY;
+                    for (size_t k = cycleStart; k < taken.size(); k++) cycleFlow = min(cycleFlow, remaining[taken[k]]);
+                    for (size_t k = cycleStart; k < taken.size(); k++) remaining[taken[k]] -= cycleFlow;
+                    for (size_t k = cycleStart + 1; k < rooms.size(); k++) pathIndex[rooms[k]] = -1;
+                    rooms.resize(cycleStart + 1);
+                    taken.resize(cycleStart);
+                    room = next;
+                    continue;
+                }
+
+                pathIndex[next] = rooms.size();
+                rooms.push_back(next);
+                room = next;
+            }
+
+            for (RoomId visited : rooms) pathIndex[visited] = -1;
+            if (room != DORMITORY) break; // Sv has no flow left
+
+            int64_t width = INFINITE_CAPACITY;
+            for (uint32_t arc : taken) width = min(width, remaining[arc]);
+            expanded.assign(1, VESTIBULE);
+            for (uint32_t arc : taken) {
+                remaining[arc] -= width;
+                if (arcs[arc].corridor != UINT32_MAX) {
+                    const vector<RoomId>& inside = reduction.corridors[arcs[arc].corridor].rooms;
+                    if (arcs[arc].reversed) {
+                        expanded.insert(expanded.end(), inside.rbegin(), inside.rend());
+                    } else {
+                        expanded.insert(expanded.end(), inside.begin(), inside.end());
+                    }
+                }
+                expanded.push_back(arcs[arc].to);
+            }
+            widths[expanded] += width;
+        }
+
+        routes.clear();
+        for (const auto& route : widths) {
+            routes.push_back({route.first, route.second});
+        }
+        stable_sort(routes.begin(), routes.end(), [](const Route& a, const Route& b) {
+            return a.length() < b.length();
+        });
+    }
+
+private:
+    // Arc out of a room: a tunnel, or a whole corridor when corridor is set
+    struct NetworkArc {
+        int edge;
+        RoomId to;
+        uint32_t corridor;
+        bool reversed; // Corridor walked from its to end
+    };
+
+    const ColonyInfo& colony;
+    ColonyReduction reduction;
+    MinCostFlow network;
+    vector<NetworkArc> arcs;      // By room, in the order of the tunnels they stand for
+    vector<uint32_t> arcOffsets;  // Arcs of room r are arcs[arcOffsets[r] .. arcOffsets[r + 1]]
+};
+
+// Makespan of count routes given by their length and width, sorted by length
+template <typename LengthOf, typename WidthOf>
+int64_t makespanOf(size_t count, LengthOf lengthOf, WidthOf widthOf, int64_t numAnts) {
+    if (numAnts <= 0) return 0;
+    if (count == 0) return -1;
+
+    // Route r delivers width * (T - length + 1) ants within T steps
+    auto delivered = [&](int64_t steps) {
+        int64_t total = 0;
+        for (size_t r = 0; r < count; r++) {
+            int64_t length = lengthOf(r);
+            if (steps < length) continue;
+            int64_t waves = steps - length + 1;
+            if (widthOf(r) >= (numAnts + waves - 1) / waves) return numAnts;
+            total += widthOf(r) * waves;
+            if (total >= numAnts) return numAnts;
+        }
+        return total;
+    };
+
+    // Routes are sorted by length, the shortest one alone finishes the job by the upper end
+    int64_t low = lengthOf(0);
+    int64_t high = low + numAnts - 1;
+    while (low < high) {
+        int64_t middle = low + (high - low) / 2;
+        if (delivered(middle) >= numAnts) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+// Augment until the route set cannot get better for colony.numAnts, keeping the best one seen
+// (and every one of them in ladder, if given)
+bool searchRoutes(const ColonyInfo& colony, vector<Route>& best, int64_t lowerBound, RouteLadder* ladder) {
+    best.clear();
+    int64_t numAnts = colony.numAnts;
+    if (numAnts <= 0) return true;
+
+    RoomNetwork network(colony);
+    vector<Route> routes;
+    map<vector<RoomId>, uint32_t> pathIndex;
+    int64_t bestMakespan = INT64_MAX;
+    int64_t routed = 0;
+    int64_t pushed = 0;
+    int64_t pathCost = 0;
+    bool augmented = true;
+
+    // Each augmentation adds the cheapest extra route (possibly rerouting older ones)
+    while (routed < numAnts && (augmented = network.augment(numAnts - routed, pushed, pathCost))) {
+        // A marginal route at least as long as the best plan cannot shorten it any more
+        if (pathCost >= bestMakespan) break;
+        routed += pushed;
+
+        network.decompose(routes);
+        if (ladder) {
+            ladder->levels.emplace_back();
+            for (const Route& route : routes) {
+                auto known = pathIndex.emplace(route.rooms, ladder->paths.size());
+                if (known.second) ladder->paths.push_back(route.rooms);
+                ladder->levels.back().push_back({known.first->second, route.width});
+            }
+        }
+        int64_t makespan = routeMakespan(routes, numAnts);
+        if (makespan < bestMakespan) {
+            bestMakespan = makespan;
+            best = routes;
+        }
+        if (bestMakespan <= lowerBound) break; // Optimal, no route set can do better
+    }
+
+    if (ladder) {
+        // Every ant routed: the last augmentation was cut short, but no smaller count needs more.
+        // Otherwise path costs only grow from one augmentation to the next.
+        bool allRouted = routed >= numAnts;
+        ladder->antLimit = allRouted ? numAnts : INT64_MAX;
+        ladder->frontier = allRouted || !augmented ? INT64_MAX : pathCost;
+    }
+    return !best.empty();
+}
+
+// Shortest routes of a set sorted by length, down to width ants per step in all
+void trimRoutes(vector<Route>& routes, int64_t width) {
+    size_t kept = 0;
+    while (kept < routes.size() && width > 0) {
+        routes[kept].width = min(routes[kept].width, width);
+        width -= routes[kept++].width;
+    }
+    routes.resize(kept);
+}
+
+// Routes ending where the next ones start, with the same total width, joined end to end: the
+// longest ones go on with the shortest next ones, widths split where they do not match
+void joinRoutes(vector<Route>& routes, const vector<Route>& next) {
+    vector<Route> joined;
+    size_t a = routes.size();
+    size_t b = 0;
+    int64_t leftA = 0;
+    int64_t leftB = 0;
+    while (true) {
+        if (leftA == 0) {
+            if (a == 0) break;
+            leftA = routes[--a].width;
+        }
+        if (leftB == 0) {
+            if (b == next.size()) break;
+            leftB = next[b++].width;
+        }
+        int64_t width = min(leftA, leftB);
+        Route route{routes[a].rooms, width};
+        route.rooms.insert(route.rooms.end(), next[b - 1].rooms.begin() + 1, next[b - 1].rooms.end());
+        joined.push_back(move(route));
+        leftA -= width;
+        leftB -= width;
+    }
+    stable_sort(joined.begin(), joined.end(), [](const Route& x, const Route& y) { return x.length() < y.length(); });
+    routes = move(joined);
+}
+
+} // namespace
+
+int64_t routeMakespan(const vector<Route>& routes, int64_t numAnts) {
+    return makespanOf(
+        routes.size(), [&](size_t r) -> int64_t { return routes[r].length(); },
+        [&](size_t r) { return routes[r].width; }, numAnts);
+}
+
+bool planRoutes(const ColonyInfo& colony, vector<Route>& best, int64_t lowerBound) {
+    return searchRoutes(colony, best, lowerBound, nullptr);
+}
+
+bool planRouteLadder(const ColonyInfo& colony, RouteLadder& ladder, int64_t lowerBound) {
+    ladder = RouteLadder();
+    vector<Route> best;
+    return searchRoutes(colony, best, lowerBound, &ladder);
+}
+
+bool pickLadderRoutes(const RouteLadder& ladder, int64_t numAnts, int64_t lowerBound, vector<Route>& routes) {
+    routes.clear();
+    if (numAnts <= 0) return true;
+    if (numAnts > ladder.antLimit) return false;
+
+    // First level with the fewest steps, as planRoutes keeps the first best one
+    const vector<pair<uint32_t, int64_t>>* bestLevel = nullptr;
+    int64_t bestMakespan = INT64_MAX;
+    for (const vector<pair<uint32_t, int64_t>>& level : ladder.levels) {
+        int64_t makespan = makespanOf(
+            level.size(), [&](size_t r) -> int64_t { return ladder.paths[level[r].first].size() - 1; },
+            [&](size_t r) { return level[r].second; }, numAnts);
+        if (makespan >= 0 && makespan < bestMakespan) {
+            bestMakespan = makespan;
+            bestLevel = &level;
+        }
+    }
+    if (!bestLevel || (bestMakespan > ladder.frontier && bestMakespan > lowerBound)) return false;
+
+    for (const pair<uint32_t, int64_t>& route : *bestLevel) {
+        routes.push_back({ladder.paths[route.first], route.second});
+    }
+    return true;
+}
+
+void scheduleOnRoutes(const vector<Route>& routes, int numAnts, Schedule& schedule) {
+    schedule.clear();
+    if (numAnts <= 0 || routes.empty()) return;
+
+    // Next ant goes where it would arrive first: route length + ants already queued on it
+    vector<vector<int>> routeAnts(routes.size());
+    priority_queue<pair<int64_t, size_t>, vector<pair<int64_t, size_t>>, greater<pair<int64_t, size_t>>> arrivals;
+    for (size_t r = 0; r < routes.size(); r++) {
+        arrivals.push({routes[r].length(), r});
+    }
+
+    int64_t makespan = 0;
+    for (int ant = 0; ant < numAnts; ant++) {
+        pair<int64_t, size_t> next = arrivals.top();
+        arrivals.pop();
+        size_t r = next.second;
+        routeAnts[r].push_back(ant);
+        makespan = max(makespan, next.first);
+        arrivals.push({routes[r].length() + (int64_t)(routeAnts[r].size() / routes[r].width), r});
+    }
+
+    // The k-th ant of a route leaves Sv with wave k / width and then advances one room per step
+    schedule.assign(makespan, vector<Move>());
+    for (size_t r = 0; r < routes.size(); r++) {
+        const Route& route = routes[r];
+        for (size_t k = 0; k < routeAnts[r].size(); k++) {
+            int64_t wave = k / route.width;
+            for (int hop = 0; hop < route.length(); hop++) {
+                schedule[wave + hop].push_back({routeAnts[r][k], route.rooms[hop], route.rooms[hop + 1]});
+            }
+        }
+    }
+    for (vector<Move>& step : schedule) {
+        sort(step.begin(), step.end(), [](const Move& a, const Move& b) { return a.ant < b.ant; });
+    }
+}
+
+bool solveWithRoutes(const ColonyInfo& colony, Schedule& schedule, int64_t lowerBound) {
+    vector<Route> routes;
+    if (!planRoutes(colony, routes, lowerBound)) return false;
+    scheduleOnRoutes(routes, colony.numAnts, schedule);
+    return true;
+}
+
+bool planSegmentRoutes(const ColonyInfo& colony, vector<Route>& routes, int64_t lowerBound, size_t threads) {
+    routes.clear();
+    if (colony.numAnts <= 0) return true; // Nothing to route, whether or not Sd can be reached
+    ColonyReduction reduction;
+    reduceColony(colony, reduction);
+    vector<ColonySegment> segments;
+    findSegments(colony, reduction, segments);
+    if (segments.size() <= 1) return planRoutes(colony, routes, lowerBound);
+
+    // Each segment for every ant, in the ids of colony (without the Sv in front of a separator).
+    // lowerBound holds for the whole colony, not for a segment on its own: each one stops at its
+    // own bound instead, where its search could not find anything better anyway.
+    vector<vector<Route>> parts(segments.size());
+    vector<int64_t> widths(segments.size(), 0);
+    auto planSegment = [&](size_t i) {
+        vector<RoomId> original;
+        ColonyInfo part = segmentColony(colony, segments[i], original);
+        StepLowerBound bound;
+        computeStepLowerBound(part, bound);
+        if (!planRoutes(part, parts[i], bound.steps)) return;
+        for (Route& route : parts[i]) {
+            if (original[VESTIBULE] == NO_ROOM) route.rooms.erase(route.rooms.begin());
+            for (RoomId& room : route.rooms) room = original[room];
+            widths[i] += route.width;
+        }
+    };
+    if (threads > 1) {
+        WorkStealingPool pool(min(threads, segments.size()));
+        pool.run(segments.size(), planSegment);
+    } else {
+        for (size_t i = 0; i < segments.size(); i++) planSegment(i);
+    }
+
+    // No more ants per step than the narrowest segment lets through
+    int64_t width = *min_element(widths.begin(), widths.end());
+    if (width <= 0) return false;
+    routes = move(parts[0]);
+    trimRoutes(routes, width);
+    for (size_t i = 1; i < parts.size(); i++) {
+        trimRoutes(parts[i], width);
+        joinRoutes(routes, parts[i]);
+    }
+    return !routes.empty();
+}
+
+bool solveWithSegments(const ColonyInfo& colony, Schedule& schedule, int64_t lowerBound, size_t threads) {
+    vector<Route> routes;
+    if (!planSegmentRoutes(colony, routes, lowerBound, threads)) return false;
+    scheduleOnRoutes(routes, colony.numAnts, schedule);
+    return true;
+}
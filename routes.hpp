@@ -0,0 +1,52 @@
+#ifndef ROUTES_H
+#define ROUTES_H
+
+#include "ants.hpp"
+
+// Sv -> Sd path that ants follow in single file, width of them leaving Sv at every step
+struct Route {
+    vector<RoomId> rooms; // Sv first, Sd last
+    int64_t width;
+
+    int length() const { return rooms.size() - 1; }
+};
+
+// Route set minimizing the step count for colony.numAnts, from a min-cost flow on the room graph.
+// A known lower bound on the step count (0 if none) ends the search as soon as a route set reaches it.
+bool planRoutes(const ColonyInfo& colony, vector<Route>& routes, int64_t lowerBound = 0);
+
+// Steps needed to send numAnts ants over the routes (closed form, no simulation)
+int64_t routeMakespan(const vector<Route>& routes, int64_t numAnts);
+
+// Every route set planRoutes goes through, one per augmentation, kept so that other ant counts on
+// the same rooms and tunnels can pick theirs without any flow computation
+struct RouteLadder {
+    vector<vector<RoomId>> paths;                   // Distinct routes of all levels, Sv first, Sd last
+    vector<vector<pair<uint32_t, int64_t>>> levels; // Each route set as path index and width, shortest first
+    int64_t antLimit = INT64_MAX;                   // Levels hold at most this many ants, larger counts need more
+    int64_t frontier = INT64_MAX;                   // Any further route is at least this long (INT64_MAX: none can help)
+};
+
+// planRoutes for colony.numAnts, recording every route set on the way
+bool planRouteLadder(const ColonyInfo& colony, RouteLadder& ladder, int64_t lowerBound = 0);
+
+// Route set of the ladder with the fewest steps for numAnts. False when the ladder cannot tell it
+// is as good as planRoutes would find: more ants than it was built for, or a further route
+// could still shorten the plan (with lowerBound the fewest steps possible for numAnts, 0 if unknown).
+bool pickLadderRoutes(const RouteLadder& ladder, int64_t numAnts, int64_t lowerBound, vector<Route>& routes);
+
+// Dispatch ants on the routes with the "length + queued ants" rule and write out every step
+void scheduleOnRoutes(const vector<Route>& routes, int numAnts, Schedule& schedule);
+
+bool solveWithRoutes(const ColonyInfo& colony, Schedule& schedule, int64_t lowerBound = 0);
+
+// planRoutes on each segment between two separators (reduction.hpp) on its own, on threads workers
+// when more than one, the route sets then joined end to end. The searches are much smaller than on
+// the whole colony, but the plan can take a few more steps: each segment picks its routes without
+// knowing about the others. lowerBound only ends the search of a colony with a single segment;
+// each segment of a longer chain stops at the lower bound of its own.
+bool planSegmentRoutes(const ColonyInfo& colony, vector<Route>& routes, int64_t lowerBound = 0, size_t threads = 0);
+
+bool solveWithSegments(const ColonyInfo& colony, Schedule& schedule, int64_t lowerBound = 0, size_t threads = 0);
+
+#endif // ROUTES_H
@@ -0,0 +1,576 @@
+#include "server.hpp"
+#include "bounds.hpp"
+#include "compiled_colony.hpp"
+#include "mapped_file.hpp"
+#include "output.hpp"
+#include "solvers.hpp"
+#include "thread_pool.hpp"
+#include "uneviedefourmi.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <future>
+#include <list>
+#include <mutex>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t MAX_REQUEST_LINE = 1 << 16;
+const size_t MAX_PAYLOAD = size_t(1) << 30;
+const size_t DEFAULT_CACHE_ENTRIES = 64;
+const int ACCEPT_POLL_MS = 200;    // How soon a stop signal is noticed
+const int ACCEPT_BACKOFF_MS = 100; // Wait before accepting again once out of file descriptors
+
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+void printServerUsage() {
+    cerr << "Usage: uneviedefourmi serve [--socket=PATH] [--threads=N] [--cache=ENTRIES]" << endl;
+}
+
+// 64-bit hash of a whole colony file, eight bytes at a time
+uint64_t contentHash(const char* data, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, size - i);
+    hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ull;
+    return hash ^ (hash >> 29);
+}
+
+// A colony loaded once, with its distances to Sd and its lower bound, shared by every request
+// on the same content
+struct CachedColony {
+    uint64_t hash;
+    string content;                 // Bytes it was loaded from, unless mapping holds them
+    shared_ptr<MappedFile> mapping; // Compiled colony the colony is bound to
+    Colony colony;
+    StepLowerBound bound;
+
+    // The hash only picks the entry: two files may share it
+    bool holds(const char* data, size_t size) const {
+        const char* bytes = mapping ? mapping->data() : content.data();
+        size_t length = mapping ? mapping->size() : content.size();
+        return length == size && memcmp(bytes, data, size) == 0;
+    }
+};
+
+// Loaded colonies by content hash; once full, the least recently used one is dropped
+class ColonyCache {
+public:
+    explicit ColonyCache(size_t capacity) : capacity(capacity) {}
+
+    // Colony of this content, loaded on a miss (mapping keeps a compiled colony in place);
+    // null when it does not load
+    shared_ptr<const CachedColony> get(const char* data, size_t size, const shared_ptr<MappedFile>& mapping, bool& hit);
+
+    void counts(size_t& entryCount, uint64_t& hitCount, uint64_t& missCount);
+
+private:
+    typedef list<shared_ptr<const CachedColony>> Entries;
+
+    mutex lock;
+    size_t capacity;
+    Entries entries; // Most recently used first
+    unordered_map<uint64_t, Entries::iterator> byHash;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+shared_ptr<const CachedColony> ColonyCache::get(const char* data, size_t size, const shared_ptr<MappedFile>& mapping, bool& hit) {
+    uint64_t hash = contentHash(data, size);
+    {
+        lock_guard<mutex> guard(lock);
+        auto found = byHash.find(hash);
+        hit = found != byHash.end() && (*found->second)->holds(data, size);
+        if (hit) {
+            hits++;
+            entries.splice(entries.begin(), entries, found->second);
+            return entries.front();
+        }
+        misses++;
+    }
+
+    // Loaded without the lock, other requests go on meanwhile
+    ColonyInfo colony;
+    bool bound = mapping && isCompiledColony(data, size);
+    bool loaded = bound ? bindCompiledColony(colony, mapping) : loadColonyFromBuffer(colony, data, size);
+    if (!loaded) return nullptr;
+    shared_ptr<CachedColony> entry = make_shared<CachedColony>();
+    entry->hash = hash;
+    if (bound) {
+        entry->mapping = mapping;
+    } else {
+        entry->content.assign(data, size);
+    }
+    entry->colony = Colony(colony);
+    computeStepLowerBound(colony, entry->bound);
+
+    lock_guard<mutex> guard(lock);
+    auto found = byHash.find(hash);
+    if (found != byHash.end()) {
+        entries.erase(found->second);
+        byHash.erase(found);
+    }
+    entries.push_front(entry);
+    byHash[hash] = entries.begin();
+    while (entries.size() > capacity) {
+        byHash.erase(entries.back()->hash);
+        entries.pop_back();
+    }
+    return entry;
+}
+
+void ColonyCache::counts(size_t& entryCount, uint64_t& hitCount, uint64_t& missCount) {
+    lock_guard<mutex> guard(lock);
+    entryCount = entries.size();
+    hitCount = hits;
+    missCount = misses;
+}
+
+// Buffered reads of request lines and payloads from stdin or a client socket
+class RequestReader {
+public:
+    explicit RequestReader(int fd) : fd(fd), buffer(1 << 16) {}
+
+    bool readLine(string& line); // Without the end of line; false at the end of the input
+    bool readBytes(size_t count, string& bytes);
+
+private:
+    int fd;
+    vector<char> buffer;
+    size_t start = 0;
+    size_t end = 0;
+
+    bool fill();
+};
+
+bool RequestReader::fill() {
+    if (start > 0) {
+        memmove(buffer.data(), buffer.data() + start, end - start);
+        end -= start;
+        start = 0;
+    }
+    if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+    ssize_t got;
+    do {
+        got = read(fd, buffer.data() + end, buffer.size() - end);
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0) return false;
+    end += got;
+    return true;
+}
+
+bool RequestReader::readLine(string& line) {
+    size_t scanned = start;
+    while (true) {
+        const char* first = buffer.data() + start;
+        const char* newline = static_cast<const char*>(memchr(buffer.data() + scanned, '\n', end - scanned));
+        if (newline) {
+            size_t length = newline - first;
+            if (length > 0 && first[length - 1] == '\r') length--;
+            line.assign(first, length);
+            start = newline - buffer.data() + 1;
+            return true;
+        }
+        if (end - start > MAX_REQUEST_LINE) return false;
+        scanned = end - start;
+        if (!fill()) return false;
+        scanned += start;
+    }
+}
+
+bool RequestReader::readBytes(size_t count, string& bytes) {
+    bytes.clear();
+    bytes.reserve(count);
+    while (bytes.size() < count) {
+        if (start == end && !fill()) return false;
+        size_t taken = min(end - start, count - bytes.size());
+        bytes.append(buffer.data() + start, taken);
+        start += taken;
+    }
+    return true;
+}
+
+bool writeAll(int fd, const string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t sent = write(fd, data.data() + written, data.size() - written);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        written += sent;
+    }
+    return true;
+}
+
+struct SolveRequest {
+    SimulationOptions options;
+    bool moves = false;
+    string file;
+    bool inline_ = false;
+    size_t payloadSize = 0;
+    string payload;
+};
+
+// "solve ..." line; payloadSize is set as soon as bytes=N was read, so that the payload can be
+// skipped even when the rest of the line is wrong
+bool parseSolveRequest(const string& line, SolveRequest& request, string& error) {
+    istringstream words(line);
+    string word;
+    words >> word;
+    bool valid = true;
+    while (words >> word) {
+        if (word.compare(0, 7, "solver=") == 0) {
+            request.options.solver = word.substr(7);
+            if (!isKnownSolver(request.options.solver)) {
+                error = "unknown solver " + request.options.solver;
+                valid = false;
+            }
+        } else if (word.compare(0, 9, "strategy=") == 0) {
+            if (!parseStrategy(word.substr(9), request.options.strategy)) {
+                error = "unknown strategy " + word.substr(9);
+                valid = false;
+            }
+        } else if (word == "moves") {
+            request.moves = true;
+        } else if (word.compare(0, 5, "file=") == 0) {
+            request.file = word.substr(5);
+        } else if (word.compare(0, 6, "bytes=") == 0) {
+            char* end;
+            unsigned long long size = strtoull(word.c_str() + 6, &end, 10);
+            if (*end != '\0' || size > MAX_PAYLOAD) {
+                error = "invalid payload size " + word.substr(6);
+                return false;
+            }
+            request.inline_ = true;
+            request.payloadSize = size;
+        } else {
+            error = "unknown request field " + word;
+            valid = false;
+        }
+    }
+    if (valid && request.file.empty() == !request.inline_) {
+        error = "expected one of file=PATH or bytes=N";
+        valid = false;
+    }
+    return valid;
+}
+
+class Server {
+public:
+    Server(size_t cacheEntries, size_t threads) : cache(cacheEntries), pool(threads) {}
+
+    // Requests of one client until it quits or goes away
+    void serveConnection(int input, int output);
+
+    size_t threadCount() const { return pool.size(); }
+
+private:
+    ColonyCache cache;
+    TaskPool pool;
+
+    string solve(const SolveRequest& request);
+    string statsAnswer();
+};
+
+string Server::solve(const SolveRequest& request) {
+    shared_ptr<MappedFile> file;
+    const char* data = request.payload.data();
+    size_t size = request.payload.size();
+    if (!request.inline_) {
+        file = make_shared<MappedFile>();
+        if (!file->open(request.file)) return "error unable to open file " + request.file + "\n";
+        data = file->data();
+        size = file->size();
+    }
+
+    bool hit;
+    shared_ptr<const CachedColony> cached = cache.get(data, size, file, hit);
+    if (!cached) return "error unable to load colony\n";
+
+    SimulationOptions options = request.options;
+    options.lowerBound = cached->bound.steps;
+    Simulation simulation(cached->colony, options);
+    if (!simulation.reachable()) return "error no path from Sv to Sd\n";
+
+    string body;
+    {
+        OutputWriter out(body);
+        for (ArrayView<Move> moves = simulation.step(); !moves.empty(); moves = simulation.step()) {
+            if (request.moves) printStep(out, cached->colony.info(), simulation.stepCount(), moves);
+        }
+    }
+    return "ok steps=" + to_string(simulation.stepCount()) + " lower_bound=" + to_string(cached->bound.steps) +
+           " cached=" + (hit ? "1" : "0") + " bytes=" + to_string(body.size()) + "\n" + body;
+}
+
+string Server::statsAnswer() {
+    size_t entries;
+    uint64_t hits, misses;
+    cache.counts(entries, hits, misses);
+    return "ok entries=" + to_string(entries) + " hits=" + to_string(hits) + " misses=" + to_string(misses) + " bytes=0\n";
+}
+
+// Answers of one connection in request order, whichever worker finishes first
+class ResponseQueue {
+public:
+    void push(future<string> response) {
+        {
+            lock_guard<mutex> guard(lock);
+            pending.push_back(move(response));
+        }
+        ready.notify_one();
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> guard(lock);
+            closed = true;
+        }
+        ready.notify_one();
+    }
+
+    // False once closed and drained
+    bool pop(future<string>& response) {
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this] { return closed || !pending.empty(); });
+        if (pending.empty()) return false;
+        response = move(pending.front());
+        pending.pop_front();
+        return true;
+    }
+
+private:
+    mutex lock;
+    condition_variable ready;
+    deque<future<string>> pending;
+    bool closed = false;
+};
+
+future<string> answered(const string& text) {
+    promise<string> answer;
+    answer.set_value(text);
+    return answer.get_future();
+}
+
+void Server::serveConnection(int input, int output) {
+    ResponseQueue responses;
+    thread writer([&] {
+        future<string> response;
+        bool open = true;
+        while (responses.pop(response)) {
+            string text = response.get();
+            if (open) open = writeAll(output, text); // A client gone away is drained all the same
+        }
+    });
+
+    RequestReader reader(input);
+    string line;
+    while (reader.readLine(line)) {
+        if (line.empty()) continue;
+        if (line == "quit") break;
+        if (line == "stats") {
+            // Counted by the writer, once the requests before it are answered
+            responses.push(async(launch::deferred, [this] { return statsAnswer(); }));
+            continue;
+        }
+        if (line.compare(0, 6, "solve ") != 0) {
+            responses.push(answered("error unknown request\n"));
+            continue;
+        }
+
+        SolveRequest request;
+        string error;
+        bool valid = parseSolveRequest(line, request, error);
+        if (request.inline_ && !reader.readBytes(request.payloadSize, request.payload)) break;
+        if (!valid) {
+            responses.push(answered("error " + error + "\n"));
+            continue;
+        }
+
+        auto task = make_shared<packaged_task<string()>>([this, request = move(request)] { return solve(request); });
+        responses.push(task->get_future());
+        pool.submit([task] { (*task)(); });
+    }
+
+    responses.close();
+    writer.join();
+}
+
+// Socket clients, each served on a thread of its own. Every thread is joined before the server
+// they use goes away.
+class Connections {
+public:
+    template <typename Serve>
+    void start(int client, Serve serve);
+
+    // Joins the threads of the clients that went away
+    void reap();
+
+    // Stops reading on every connection (requests already read are still answered) and joins
+    // all of them
+    void stop();
+
+private:
+    struct Connection {
+        int fd = -1;
+        bool done = false;
+        thread worker;
+    };
+
+    mutex lock;
+    list<Connection> connections;
+};
+
+template <typename Serve>
+void Connections::start(int client, Serve serve) {
+    lock_guard<mutex> guard(lock);
+    auto connection = connections.emplace(connections.end());
+    connection->fd = client;
+    connection->worker = thread([this, connection, serve] {
+        serve(connection->fd);
+        // Closed under the lock so that stop never shuts down a descriptor already reused
+        lock_guard<mutex> guard(lock);
+        ::close(connection->fd);
+        connection->done = true;
+    });
+}
+
+void Connections::reap() {
+    lock_guard<mutex> guard(lock);
+    for (auto connection = connections.begin(); connection != connections.end();) {
+        if (!connection->done) {
+            ++connection;
+            continue;
+        }
+        connection->worker.join();
+        connection = connections.erase(connection);
+    }
+}
+
+void Connections::stop() {
+    {
+        lock_guard<mutex> guard(lock);
+        for (Connection& connection : connections) {
+            if (!connection.done) shutdown(connection.fd, SHUT_RD);
+        }
+    }
+    // Only this thread adds or removes connections, so the list can be walked without the lock
+    for (Connection& connection : connections) connection.worker.join();
+    connections.clear();
+}
+
+// Listening socket at path; a socket left there by an earlier server is replaced, anything
+// else is not touched
+int listenOn(const string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cerr << "Error: socket path too long " << path << endl;
+        return -1;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    struct stat existing;
+    if (stat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) unlink(path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        cerr << "Error: unable to listen on " << path << ": " << strerror(errno) << endl;
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+int runServer(int argc, char* argv[]) {
+    string socketPath;
+    size_t threads = defaultThreadCount();
+    size_t cacheEntries = DEFAULT_CACHE_ENTRIES;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 9, "--socket=") == 0) {
+            socketPath = arg.substr(9);
+        } else if (arg.compare(0, 10, "--threads=") == 0 || arg.compare(0, 8, "--cache=") == 0) {
+            size_t prefix = arg.find('=') + 1;
+            char* end;
+            long count = strtol(arg.c_str() + prefix, &end, 10);
+            if (*end != '\0' || count <= 0) {
+                cerr << "Error: invalid count " << arg.substr(prefix) << endl;
+                return 1;
+            }
+            (arg[2] == 't' ? threads : cacheEntries) = count;
+        } else {
+            printServerUsage();
+            return 1;
+        }
+    }
+
+    // A client closing its socket early must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+    Server server(cacheEntries, threads);
+
+    if (socketPath.empty()) {
+        server.serveConnection(STDIN_FILENO, STDOUT_FILENO);
+        return 0;
+    }
+
+    int listener = listenOn(socketPath);
+    if (listener < 0) return 1;
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    cerr << "Serving on " << socketPath << " with " << server.threadCount() << " threads" << endl;
+
+    // Until SIGINT or SIGTERM; the signal may reach any thread, so the listener is polled
+    // with a timeout rather than blocked on
+    Connections connections;
+    int status = 0;
+    bool starved = false;
+    while (!stopRequested) {
+        pollfd waiting = {listener, POLLIN, 0};
+        int ready = poll(&waiting, 1, ACCEPT_POLL_MS);
+        connections.reap();
+        if (ready <= 0) continue;
+
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) continue;
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                // Out of descriptors or memory for now: wait for connections to close
+                if (!starved) cerr << "Error: accept failed: " << strerror(errno) << ", retrying" << endl;
+                starved = true;
+                this_thread::sleep_for(chrono::milliseconds(ACCEPT_BACKOFF_MS));
+                continue;
+            }
+            cerr << "Error: accept failed: " << strerror(errno) << endl;
+            status = 1;
+            break;
+        }
+        starved = false;
+        connections.start(client, [&server](int fd) { server.serveConnection(fd, fd); });
+    }
+
+    ::close(listener);
+    unlink(socketPath.c_str());
+    connections.stop();
+    return status;
+}
@@ -0,0 +1,24 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "ants.hpp"
+
+// "serve" subcommand: a long-running solver that keeps the colonies it loaded in memory, so a
+// request on a colony it has already seen costs a hash and a comparison of the file and the solve
+// itself.
+//
+// Requests are read from stdin (answers on stdout), or from every client of a Unix domain
+// socket with --socket=PATH. One line per request, followed by the colony when it is sent inline:
+//   solve [solver=NAME] [strategy=NAME] [moves] file=PATH
+//   solve [solver=NAME] [strategy=NAME] [moves] bytes=N     then N bytes of colony text
+//   stats
+//   quit                                                     ends the connection (or stdin)
+// Each connection is answered in the order of its requests, while the solves run concurrently
+// on the worker pool:
+//   ok steps=S lower_bound=B cached=0|1 bytes=N              then N bytes: the steps as the
+//                                                            program prints them, with "moves"
+//   ok entries=E hits=H misses=M bytes=0                     answer to stats
+//   error MESSAGE
+int runServer(int argc, char* argv[]);
+
+#endif // SERVER_H
@@ -0,0 +1,145 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "ants.hpp"
+#include "stats.hpp"
+
+// Step simulation shared by every path strategy. Each step, the ants with the lowest
+// priority plan first and take the room their strategy picks, if any.
+//
+// A Strategy provides:
+//   int priority(RoomId position, const vector<int>& occupancy)
+//       rank of an ant at the start of the step (lower moves first, ties go to f1 before f2)
+//   RoomId nextRoom(RoomId position, const vector<int>& tempOccupancy)
+//       room to move to given the moves planned so far, NO_ROOM to wait
+//   void planned(RoomId from, RoomId to, const vector<int>& tempOccupancy)
+//       an ant was planned from one room to another and tempOccupancy already counts it; the
+//       occupancy at the start of the next step is the tempOccupancy after the last move
+// They are called on the concrete type, so the strategy is inlined into this loop.
+//
+// Applying a step only moves the planned ants, so the occupancy planned moves see is the real
+// one with the moves planned so far applied: the planned moves are the log of what changed
+// since the step started and the occupancy is updated in place, never copied. Every buffer
+// lives across steps, so once they have grown a step allocates nothing but its entry in the
+// schedule. Steps are taken one at a time, so a caller can stream them instead of keeping the
+// whole schedule. Only the ants still on their way are looked at (AntTable::active), and the
+// priorities and the order of a step are indexed by their slot in that list.
+template <typename Strategy>
+class StepSimulation {
+public:
+    StepSimulation(const ColonyInfo& colony, AntTable& ants, Strategy& strategy)
+        : ants(ants), strategy(strategy), occupancy(colony.roomCount(), 0), stepLimit(simulationStepLimit(colony)) {}
+
+    // Plan and apply the next step; false once no ant can move any more (safety limit included)
+    bool step(vector<Move>& moves);
+
+private:
+    AntTable& ants;
+    Strategy& strategy;
+    vector<int> occupancy; // Room id -> number of ants inside
+    vector<int> priority;  // Slot in ants.active -> rank for this step
+    vector<int> antOrder;  // Slots in ants.active, in planning order
+    vector<pair<int, RoomId>> plannedMoves;
+    int64_t stepLimit;
+    int64_t stepsDone = 0;
+};
+
+template <typename Strategy>
+bool StepSimulation<Strategy>::step(vector<Move>& moves) {
+    moves.clear();
+    if (stepsDone >= stepLimit) return false; // Safety limit
+
+    STAT_STEP_TIMER();
+    plannedMoves.clear();
+
+    // Sort ants by priority, each one ranked once per step
+    int numActive = ants.active.size();
+    antOrder.resize(numActive);
+    priority.resize(numActive);
+    for (int slot = 0; slot < numActive; slot++) {
+        antOrder[slot] = slot;
+        priority[slot] = strategy.priority(ants.position[ants.active[slot]], occupancy);
+    }
+
+    sort(antOrder.begin(), antOrder.end(), [&](int a, int b) {
+        if (priority[a] == priority[b]) {
+            return a < b; // f1 before f2, etc. (active is in index order)
+        }
+        return priority[a] < priority[b];
+    });
+
+    // Plan next moves
+    for (int slot : antOrder) {
+        int antIndex = ants.active[slot];
+        RoomId current = ants.position[antIndex];
+        RoomId nextRoom = strategy.nextRoom(current, occupancy);
+
+        if (nextRoom != NO_ROOM) {
+            plannedMoves.push_back({antIndex, nextRoom});
+            STAT_INC(STAT_MOVES_PLANNED);
+
+            // The move takes effect on the occupancy right away
+            if (current != VESTIBULE && current != DORMITORY) {
+                occupancy[current]--;
+            }
+            if (nextRoom != VESTIBULE && nextRoom != DORMITORY) {
+                occupancy[nextRoom]++;
+            }
+            strategy.planned(current, nextRoom, occupancy);
+        } else {
+            STAT_INC(STAT_MOVES_REJECTED);
+        }
+    }
+
+    // Apply planned moves (none once every ant is in Sd, or when they are all stuck)
+    if (plannedMoves.empty()) return false;
+
+    bool arrived = false;
+    for (auto& move : plannedMoves) {
+        int idx = move.first;
+        RoomId from = ants.position[idx];
+        RoomId to = move.second;
+
+        ants.moveTo(idx, to, stepsDone + 1);
+        arrived = arrived || to == DORMITORY;
+
+        moves.push_back({idx, from, to});
+    }
+    if (arrived) ants.compact();
+    stepsDone++;
+    return true;
+}
+
+// Every step of the simulation, one after the other
+template <typename Strategy>
+void runStepSimulation(const ColonyInfo& colony, AntTable& ants, Schedule& schedule, Strategy& strategy) {
+    StepSimulation<Strategy> simulation(colony, ants, strategy);
+    vector<Move> moves;
+    while (simulation.step(moves)) {
+        schedule.push_back(moves);
+    }
+}
+
+// A step simulation behind a virtual call, for callers that only learn at runtime what drives
+// it (see makeStrategyEngine); the strategy itself is still inlined into the step loop
+class StepEngine {
+public:
+    virtual ~StepEngine() {}
+
+    // Moves of the next step; false once no ant can move any more
+    virtual bool step(vector<Move>& moves) = 0;
+};
+
+template <typename Strategy>
+class StrategyEngine : public StepEngine {
+public:
+    StrategyEngine(const ColonyInfo& colony, AntTable& ants) : strategy{colony}, simulation(colony, ants, strategy) {}
+
+    bool step(vector<Move>& moves) override { return simulation.step(moves); }
+
+private:
+    Strategy strategy;
+    StepSimulation<Strategy> simulation;
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,49 @@
+#include "solvers.hpp"
+#include "aggregate.hpp"
+#include "reduction.hpp"
+#include "uneviedefourmi.hpp"
+
+bool isKnownSolver(const string& solver) {
+    for (const string& name : solverNames()) {
+        if (name == solver) return true;
+    }
+    return false;
+}
+
+const vector<string>& solverNames() {
+    static const vector<string> names = {"greedy", "flow", "paths", "aggregate", "events"};
+    return names;
+}
+
+bool solveColony(const ColonyInfo& colony, const string& solver, Schedule& schedule, size_t plannerThreads, PathStrategy strategy,
+                 int64_t lowerBound) {
+    SimulationOptions options;
+    options.solver = solver;
+    options.strategy = strategy;
+    options.plannerThreads = plannerThreads;
+    options.lowerBound = lowerBound;
+    Simulation simulation(colony, options);
+    if (!simulation.reachable()) return false;
+
+    for (ArrayView<Move> moves = simulation.step(); !moves.empty(); moves = simulation.step()) {
+        schedule.push_back(vector<Move>(moves.begin(), moves.end()));
+    }
+    return true;
+}
+
+bool countAggregateSteps(const ColonyInfo& colony, int64_t& steps, int64_t& moveCount, bool eventDriven) {
+    // The same pruned colony as Simulation and the command line
+    ColonyInfo pruned = withoutDeadRooms(colony);
+    AggregateSimulation simulation(pruned, eventDriven);
+    steps = 0;
+    moveCount = 0;
+    if (!simulation.finished() && !simulation.reachable()) return false;
+
+    AggregateStep moves;
+    int64_t stepLimit = simulationStepLimit(colony);
+    while (!simulation.finished() && steps < stepLimit && simulation.step(moves)) {
+        steps++;
+        moveCount += moves.moveCount();
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef SOLVERS_H
+#define SOLVERS_H
+
+#include "ants.hpp"
+#include "strategies.hpp"
+
+// Names accepted by --solver
+bool isKnownSolver(const string& solver);
+const vector<string>& solverNames();
+
+// Every step of a Simulation (uneviedefourmi.hpp) kept in one schedule; false when Sd cannot be reached.
+// The greedy engine moves ants with the given path strategy; with plannerThreads > 0 the bfs
+// strategy plans each step on that many threads. The flow and paths solvers stop searching
+// once they reach lowerBound (see computeStepLowerBound, 0 if unknown).
+bool solveColony(const ColonyInfo& colony, const string& solver, Schedule& schedule, size_t plannerThreads = 0,
+                 PathStrategy strategy = STRATEGY_BFS, int64_t lowerBound = 0);
+
+// Run the aggregate engine (event driven for the events solver) without keeping its moves; false
+// when Sd cannot be reached
+bool countAggregateSteps(const ColonyInfo& colony, int64_t& steps, int64_t& moveCount, bool eventDriven = false);
+
+#endif // SOLVERS_H
@@ -0,0 +1,127 @@
+#include "stats.hpp"
+#include "output.hpp"
+
+#include <mutex>
+
+namespace {
+
+const char* const COUNTER_NAMES[STAT_COUNTER_COUNT] = {
+    "bfs_searches", "dijkstra_searches", "astar_searches", "incremental_queries",
+    "nodes_expanded", "queue_pushes", "moves_planned", "moves_rejected",
+    "route_cache_hits", "route_cache_misses", "rooms_pruned", "corridor_rooms"};
+
+#ifdef UNEVIEDEFOURMI_STATS
+mutex registryLock;
+vector<ThreadStats*> liveThreads;
+StatValues exitedThreads;
+#endif
+
+} // namespace
+
+void StatValues::add(const StatValues& other) {
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+        counters[i] += other.counters[i];
+    }
+    steps += other.steps;
+    stepNanoseconds += other.stepNanoseconds;
+    for (int i = 0; i < STEP_HISTOGRAM_BUCKETS; i++) {
+        stepHistogram[i] += other.stepHistogram[i];
+    }
+}
+
+#ifdef UNEVIEDEFOURMI_STATS
+
+thread_local ThreadStats threadStats;
+
+ThreadStats::ThreadStats() {
+    lock_guard<mutex> guard(registryLock);
+    liveThreads.push_back(this);
+}
+
+ThreadStats::~ThreadStats() {
+    lock_guard<mutex> guard(registryLock);
+    exitedThreads.add(*this);
+    liveThreads.erase(find(liveThreads.begin(), liveThreads.end(), this));
+}
+
+bool statsEnabled() {
+    return true;
+}
+
+StatValues collectStats() {
+    lock_guard<mutex> guard(registryLock);
+    StatValues total = exitedThreads;
+    for (const ThreadStats* thread : liveThreads) {
+        total.add(*thread);
+    }
+    return total;
+}
+
+void resetStats() {
+    lock_guard<mutex> guard(registryLock);
+    exitedThreads = StatValues();
+    for (ThreadStats* thread : liveThreads) {
+        static_cast<StatValues&>(*thread) = StatValues();
+    }
+}
+
+#else
+
+ThreadStats::ThreadStats() {}
+ThreadStats::~ThreadStats() {}
+
+bool statsEnabled() {
+    return false;
+}
+
+StatValues collectStats() {
+    return StatValues();
+}
+
+void resetStats() {}
+
+#endif
+
+void ThreadStats::recordStep(uint64_t nanoseconds) {
+    steps++;
+    stepNanoseconds += nanoseconds;
+    int bucket = 0;
+    for (uint64_t micros = nanoseconds / 1000; micros > 0 && bucket < STEP_HISTOGRAM_BUCKETS - 1; micros >>= 1) {
+        bucket++;
+    }
+    stepHistogram[bucket]++;
+}
+
+// {"phases": {...}, "counters": {...}, "steps": {..., "histogram": [...]}}; the histogram only
+// lists the buckets holding at least one step, each with its upper bound
+void writeStatsJson(OutputWriter& out, const StatValues& stats, const vector<PhaseTime>& phases) {
+    out << "{\n";
+    out << "  \"phases\": {";
+    for (size_t i = 0; i < phases.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << phases[i].name << "_seconds\": ";
+        out.writeFixed(phases[i].seconds, 6);
+    }
+    out << "\n  },\n";
+
+    out << "  \"counters\": {";
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << COUNTER_NAMES[i] << "\": " << size_t(stats.counters[i]);
+    }
+    out << "\n  },\n";
+
+    out << "  \"steps\": {\n";
+    out << "    \"count\": " << size_t(stats.steps) << ",\n";
+    out << "    \"total_seconds\": ";
+    out.writeFixed(stats.stepNanoseconds / 1e9, 6);
+    out << ",\n    \"histogram\": [";
+    bool first = true;
+    for (int i = 0; i < STEP_HISTOGRAM_BUCKETS; i++) {
+        if (stats.stepHistogram[i] == 0) continue;
+        out << (first ? "\n" : ",\n") << "      {\"below_us\": " << (size_t(1) << i)
+            << ", \"steps\": " << size_t(stats.stepHistogram[i]) << "}";
+        first = false;
+    }
+    out << (first ? "]\n" : "\n    ]\n");
+    out << "  }\n";
+    out << "}\n";
+}
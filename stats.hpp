@@ -0,0 +1,89 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "ants.hpp"
+
+#include <chrono>
+
+class OutputWriter;
+
+// Hot-path counters for --stats. They are only compiled in when UNEVIEDEFOURMI_STATS is
+// defined (cmake -DUNEVIEDEFOURMI_STATS=ON, the default); otherwise every STAT_* macro
+// expands to nothing and the searches are exactly what they were.
+enum StatCounter {
+    STAT_BFS_SEARCHES,         // Hop-count BFS runs (reverse BFS from Sd, findShortestPath, flow levels)
+    STAT_DIJKSTRA_SEARCHES,    // Full weighted searches (congestion Dijkstra, min-cost flow)
+    STAT_ASTAR_SEARCHES,
+    STAT_INCREMENTAL_QUERIES,  // Path queries answered by the incremental congestion paths
+    STAT_NODES_EXPANDED,       // Rooms (or flow nodes) taken out of a queue and scanned
+    STAT_QUEUE_PUSHES,
+    STAT_MOVES_PLANNED,
+    STAT_MOVES_REJECTED,       // An ant found no room with space and waited
+    STAT_ROUTE_CACHE_HITS,     // Paths solver runs answered from the route cache (route_cache.hpp)
+    STAT_ROUTE_CACHE_MISSES,
+    STAT_ROOMS_PRUNED,         // Rooms on no simple Sv -> Sd path, left out of planning (reduction.hpp)
+    STAT_CORRIDOR_ROOMS,       // Useful rooms inside a corridor
+    STAT_COUNTER_COUNT
+};
+
+const int STEP_HISTOGRAM_BUCKETS = 40; // Bucket k holds steps taking [2^(k-1), 2^k) microseconds
+
+struct StatValues {
+    uint64_t counters[STAT_COUNTER_COUNT] = {};
+    uint64_t steps = 0;
+    uint64_t stepNanoseconds = 0;
+    uint64_t stepHistogram[STEP_HISTOGRAM_BUCKETS] = {};
+
+    void add(const StatValues& other);
+};
+
+// Counters of one thread; they register themselves so the totals can cover every thread
+// still alive, and are folded into the totals when their thread exits
+struct ThreadStats : StatValues {
+    ThreadStats();
+    ~ThreadStats();
+    ThreadStats(const ThreadStats&) = delete;
+    ThreadStats& operator=(const ThreadStats&) = delete;
+
+    void recordStep(uint64_t nanoseconds);
+};
+
+#ifdef UNEVIEDEFOURMI_STATS
+extern thread_local ThreadStats threadStats;
+
+// Wall time of one simulation step, from construction to the end of the scope
+class StepTimer {
+public:
+    StepTimer() : start(chrono::steady_clock::now()) {}
+    ~StepTimer() {
+        threadStats.recordStep(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    chrono::steady_clock::time_point start;
+};
+
+#define STAT_ADD(counter, amount) (threadStats.counters[counter] += (amount))
+#define STAT_STEP_TIMER() StepTimer stepTimer
+#else
+#define STAT_ADD(counter, amount) ((void)0)
+#define STAT_STEP_TIMER() ((void)0)
+#endif
+#define STAT_INC(counter) STAT_ADD(counter, 1)
+
+// False when the counters were compiled out
+bool statsEnabled();
+
+// Sum over every thread, and back to zero everywhere (no search may be running)
+StatValues collectStats();
+void resetStats();
+
+// Wall time of a phase of the run (load, solve, output...), reported as is
+struct PhaseTime {
+    string name;
+    double seconds;
+};
+
+void writeStatsJson(OutputWriter& out, const StatValues& stats, const vector<PhaseTime>& phases);
+
+#endif // STATS_H
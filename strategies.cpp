@@ -0,0 +1,80 @@
+#include "strategies.hpp"
+#include "routes.hpp"
+#include "simulation.hpp"
+
+namespace {
+
+const char* const STRATEGY_NAMES[STRATEGY_COUNT] = {"bfs", "dijkstra", "dijkstra-scratch", "astar", "flow"};
+
+} // namespace
+
+bool parseStrategy(const string& name, PathStrategy& strategy) {
+    for (int i = 0; i < STRATEGY_COUNT; i++) {
+        if (name == STRATEGY_NAMES[i]) {
+            strategy = PathStrategy(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* strategyName(PathStrategy strategy) {
+    return STRATEGY_NAMES[strategy];
+}
+
+FlowRouteStrategy::FlowRouteStrategy(const ColonyInfo& colony) : colony(colony) {
+    size_t numRooms = colony.roomCount();
+    routeDistance.assign(numRooms, UNREACHABLE);
+
+    vector<Route> routes;
+    vector<pair<RoomId, RoomId>> routeTunnels;
+    if (planRoutes(colony, routes)) {
+        for (const Route& route : routes) {
+            int length = route.length();
+            for (int i = 0; i <= length; i++) {
+                routeDistance[route.rooms[i]] = min(routeDistance[route.rooms[i]], length - i);
+                if (i < length) routeTunnels.push_back({route.rooms[i], route.rooms[i + 1]});
+            }
+        }
+    }
+    sort(routeTunnels.begin(), routeTunnels.end());
+    routeTunnels.erase(unique(routeTunnels.begin(), routeTunnels.end()), routeTunnels.end());
+
+    successorOffsets.assign(numRooms + 1, 0);
+    for (const pair<RoomId, RoomId>& tunnel : routeTunnels) {
+        successorOffsets[tunnel.first + 1]++;
+    }
+    for (size_t room = 0; room < numRooms; room++) {
+        successorOffsets[room + 1] += successorOffsets[room];
+    }
+    successors.reserve(routeTunnels.size());
+    for (const pair<RoomId, RoomId>& tunnel : routeTunnels) {
+        successors.push_back(tunnel.second);
+    }
+}
+
+unique_ptr<StepEngine> makeStrategyEngine(const ColonyInfo& colony, AntTable& ants, PathStrategy strategy) {
+    switch (strategy) {
+    case STRATEGY_BFS:
+        return make_unique<StrategyEngine<HopStrategy>>(colony, ants);
+    case STRATEGY_DIJKSTRA:
+        return make_unique<StrategyEngine<IncrementalCongestionStrategy>>(colony, ants);
+    case STRATEGY_DIJKSTRA_SCRATCH:
+        return make_unique<StrategyEngine<CongestionStrategy>>(colony, ants);
+    case STRATEGY_ASTAR:
+        return make_unique<StrategyEngine<AStarStrategy>>(colony, ants);
+    case STRATEGY_FLOW:
+        return make_unique<StrategyEngine<FlowRouteStrategy>>(colony, ants);
+    case STRATEGY_COUNT:
+        break;
+    }
+    return nullptr;
+}
+
+void runStrategySimulation(const ColonyInfo& colony, AntTable& ants, Schedule& schedule, PathStrategy strategy) {
+    unique_ptr<StepEngine> engine = makeStrategyEngine(colony, ants, strategy);
+    vector<Move> moves;
+    while (engine->step(moves)) {
+        schedule.push_back(moves);
+    }
+}
@@ -0,0 +1,161 @@
+#ifndef STRATEGIES_H
+#define STRATEGIES_H
+
+#include "ants.hpp"
+#include "dijkstra.hpp"
+#include "incremental_paths.hpp"
+
+// Path strategies of the step simulation (--strategy)
+enum PathStrategy {
+    STRATEGY_BFS,              // Hop distance to Sd from the reverse BFS
+    STRATEGY_DIJKSTRA,         // Congestion-weighted distances to Sd, repaired incrementally
+    STRATEGY_DIJKSTRA_SCRATCH, // Same weights, one full Dijkstra per ant and step (reference)
+    STRATEGY_ASTAR,            // Same weights searched with A* toward Sd
+    STRATEGY_FLOW,             // Stay on the min-cost route set of the paths solver
+    STRATEGY_COUNT
+};
+
+bool parseStrategy(const string& name, PathStrategy& strategy);
+const char* strategyName(PathStrategy strategy);
+
+// Nearest free room by hop count
+struct HopStrategy {
+    const ColonyInfo& colony;
+
+    int priority(RoomId position, const vector<int>&) const {
+        return hopsToDormitory(colony, position);
+    }
+    RoomId nextRoom(RoomId position, const vector<int>& tempOccupancy) const {
+        return chooseBestNextRoom(colony, position, tempOccupancy);
+    }
+    void planned(RoomId, RoomId, const vector<int>&) {}
+};
+
+// Ants are ranked by the length of their congestion-aware path (no path ranks last, as in
+// every strategy: an ant that cannot get closer to Sd does not take a room before one that can)
+class CongestionStrategy {
+public:
+    explicit CongestionStrategy(const ColonyInfo& colony) : colony(colony), search(colony) {}
+
+    int priority(RoomId position, const vector<int>& occupancy) {
+        return search.run(position, DORMITORY, occupancy) ? search.pathRooms() : UNREACHABLE;
+    }
+    RoomId nextRoom(RoomId position, const vector<int>& tempOccupancy) {
+        return chooseBestNextRoomDijkstra(colony, search, position, tempOccupancy);
+    }
+    void planned(RoomId, RoomId, const vector<int>&) {}
+
+private:
+    const ColonyInfo& colony;
+    CongestionSearch search;
+};
+
+// Same ranking and choice as CongestionStrategy, but the distances to Sd are kept between
+// queries and only repaired around the rooms a planned move pushed into another congestion
+// band. Both break ties between paths the same way, so they plan the same moves.
+class IncrementalCongestionStrategy {
+public:
+    explicit IncrementalCongestionStrategy(const ColonyInfo& colony) : colony(colony), paths(colony) {}
+
+    int priority(RoomId position, const vector<int>&) {
+        int pathRooms;
+        RoomId next = paths.nextOnPath(position, pathRooms);
+        return next != NO_ROOM ? pathRooms : UNREACHABLE;
+    }
+
+    RoomId nextRoom(RoomId position, const vector<int>& tempOccupancy) {
+        RoomRange options = colony.neighbors(position);
+        for (RoomId room : options) {
+            if (room == DORMITORY) return room;
+        }
+
+        int pathRooms;
+        RoomId next = paths.nextOnPath(position, pathRooms);
+        if (next != NO_ROOM && tempOccupancy[next] < colony.roomCapacity[next]) return next;
+
+        for (RoomId room : options) {
+            if (tempOccupancy[room] < colony.roomCapacity[room]) return room;
+        }
+        return NO_ROOM;
+    }
+
+    void planned(RoomId from, RoomId to, const vector<int>& tempOccupancy) {
+        paths.roomChanged(from, tempOccupancy);
+        paths.roomChanged(to, tempOccupancy);
+    }
+
+private:
+    const ColonyInfo& colony;
+    IncrementalCongestionPaths paths;
+};
+
+class AStarStrategy {
+public:
+    explicit AStarStrategy(const ColonyInfo& colony) : colony(colony), search(colony) {}
+
+    int priority(RoomId position, const vector<int>& occupancy) {
+        return search.run(position, occupancy) ? search.pathRooms() : UNREACHABLE;
+    }
+    RoomId nextRoom(RoomId position, const vector<int>& tempOccupancy) {
+        return chooseBestNextRoomAStar(colony, search, position, tempOccupancy);
+    }
+    void planned(RoomId, RoomId, const vector<int>&) {}
+
+private:
+    const ColonyInfo& colony;
+    AStarSearch search;
+};
+
+// Ants only take the tunnels used by the route set of planRoutes and wait when the next
+// route room is full, instead of spilling into side rooms; the routes come from a flow
+// without cycles, so the ant furthest along can always move. Off the routes (no route
+// found), ants fall back to the hop strategy.
+class FlowRouteStrategy {
+public:
+    explicit FlowRouteStrategy(const ColonyInfo& colony);
+
+    int priority(RoomId position, const vector<int>&) const {
+        int distance = routeDistance[position];
+        return distance != UNREACHABLE ? distance : hopsToDormitory(colony, position);
+    }
+
+    RoomId nextRoom(RoomId position, const vector<int>& tempOccupancy) const {
+        for (RoomId room : colony.neighbors(position)) {
+            if (room == DORMITORY) return room;
+        }
+
+        uint32_t first = successorOffsets[position];
+        uint32_t last = successorOffsets[position + 1];
+        if (first == last) return chooseBestNextRoom(colony, position, tempOccupancy);
+
+        RoomId bestRoom = NO_ROOM;
+        int shortestDistance = UNREACHABLE;
+        for (uint32_t i = first; i < last; i++) {
+            RoomId room = successors[i];
+            if (tempOccupancy[room] < colony.roomCapacity[room] && routeDistance[room] < shortestDistance) {
+                shortestDistance = routeDistance[room];
+                bestRoom = room;
+            }
+        }
+        return bestRoom;
+    }
+
+    void planned(RoomId, RoomId, const vector<int>&) {}
+
+private:
+    const ColonyInfo& colony;
+    vector<int> routeDistance;         // Room id -> rooms left to Sd along the shortest route through it
+    vector<uint32_t> successorOffsets; // CSR like the tunnel graph: next rooms of r on some route
+    vector<RoomId> successors;
+};
+
+class StepEngine;
+
+// Step simulation of the ants with the given strategy (the only place the strategy is chosen at
+// runtime); the engine keeps references to colony and ants
+unique_ptr<StepEngine> makeStrategyEngine(const ColonyInfo& colony, AntTable& ants, PathStrategy strategy);
+
+// Every step of that simulation at once
+void runStrategySimulation(const ColonyInfo& colony, AntTable& ants, Schedule& schedule, PathStrategy strategy);
+
+#endif // STRATEGIES_H
@@ -0,0 +1,162 @@
+#include "thread_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(size_t threads) : queues(threads > 0 ? threads : 1) {}
+
+size_t defaultThreadCount() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+bool WorkStealingPool::take(size_t worker, size_t& job) {
+    {
+        WorkQueue& own = queues[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest job of the next worker that still has some
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkQueue& victim = queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+// No job is ever added while running, so once nothing can be taken or stolen the worker is done
+void WorkStealingPool::work(size_t worker, const std::function<void(size_t)>& job) {
+    size_t next;
+    while (take(worker, next)) {
+        job(next);
+    }
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t)>& job) {
+    // Contiguous blocks, each worker starts at the front of its block
+    size_t workers = queues.size();
+    for (size_t w = 0; w < workers; w++) {
+        size_t first = count * w / workers;
+        size_t last = count * (w + 1) / workers;
+        for (size_t i = last; i > first; i--) {
+            queues[w].jobs.push_back(i - 1);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++) {
+        threads.emplace_back(&WorkStealingPool::work, this, w, std::cref(job));
+    }
+    work(0, job);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+WorkerTeam::WorkerTeam(size_t threadCount) {
+    for (size_t worker = 1; worker < threadCount; worker++) {
+        threads.emplace_back(&WorkerTeam::loop, this, worker);
+    }
+}
+
+WorkerTeam::~WorkerTeam() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerTeam::runChunk(size_t chunk) {
+    size_t workers = size();
+    size_t begin = count * chunk / workers;
+    size_t end = count * (chunk + 1) / workers;
+    if (begin < end) (*body)(chunk, begin, end);
+}
+
+void WorkerTeam::loop(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runChunk(worker);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            pending--;
+        }
+        finished.notify_one();
+    }
+}
+
+void WorkerTeam::parallelFor(size_t items, const std::function<void(size_t, size_t, size_t)>& work, size_t minParallel) {
+    if (threads.empty() || items < minParallel) {
+        if (items > 0) work(0, 0, items);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        body = &work;
+        count = items;
+        pending = threads.size();
+        generation++;
+    }
+    wake.notify_all();
+    runChunk(0);
+
+    std::unique_lock<std::mutex> guard(lock);
+    finished.wait(guard, [&] { return pending == 0; });
+}
+
+TaskPool::TaskPool(size_t threadCount) {
+    for (size_t worker = 0; worker < (threadCount > 0 ? threadCount : 1); worker++) {
+        threads.emplace_back(&TaskPool::loop, this);
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void TaskPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void TaskPool::loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
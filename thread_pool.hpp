@@ -0,0 +1,91 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool where every worker owns a deque of job indices: it takes from the back
+// of its own deque and, once that is empty, steals from the front of the others
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads);
+
+    size_t size() const { return queues.size(); }
+
+    // Run job(i) for every i in [0, count) and return once all of them are done
+    void run(size_t count, const std::function<void(size_t)>& job);
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+
+    std::vector<WorkQueue> queues;
+
+    bool take(size_t worker, size_t& job);
+    void work(size_t worker, const std::function<void(size_t)>& job);
+};
+
+// Persistent team for data-parallel loops inside one job: the threads are started once and
+// woken for every parallelFor, the calling thread doing the first chunk itself
+class WorkerTeam {
+public:
+    explicit WorkerTeam(size_t threads);
+    ~WorkerTeam();
+    WorkerTeam(const WorkerTeam&) = delete;
+    WorkerTeam& operator=(const WorkerTeam&) = delete;
+
+    size_t size() const { return threads.size() + 1; }
+
+    // Split [0, count) into size() contiguous chunks and run body(chunk, begin, end) on each,
+    // returning once all are done. Below minParallel items everything runs as chunk 0.
+    void parallelFor(size_t count, const std::function<void(size_t, size_t, size_t)>& body, size_t minParallel = 1024);
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t, size_t, size_t)>* body = nullptr;
+    size_t count = 0;
+    uint64_t generation = 0;
+    size_t pending = 0;
+    bool stopping = false;
+
+    void loop(size_t worker);
+    void runChunk(size_t chunk);
+};
+
+// Long-lived workers for independent tasks submitted one at a time (the server's requests)
+class TaskPool {
+public:
+    explicit TaskPool(size_t threads);
+    ~TaskPool(); // Runs the tasks still queued, then stops the workers
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    size_t size() const { return threads.size(); }
+
+    void submit(std::function<void()> task);
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+
+    void loop();
+};
+
+// Number of workers matching the machine (at least one)
+size_t defaultThreadCount();
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,115 @@
+#include "uneviedefourmi.hpp"
+#include "aggregate.hpp"
+#include "flow.hpp"
+#include "parallel_planner.hpp"
+#include "reduction.hpp"
+#include "route_cache.hpp"
+#include "routes.hpp"
+#include "simulation.hpp"
+
+namespace {
+
+// Solvers that plan the whole schedule before the first step hand it out a step at a time
+class ScheduleEngine : public StepEngine {
+public:
+    explicit ScheduleEngine(Schedule& planned) { schedule.swap(planned); }
+
+    bool step(vector<Move>& moves) override {
+        if (next == schedule.size()) return false;
+        moves.swap(schedule[next++]);
+        return true;
+    }
+
+private:
+    Schedule schedule;
+    size_t next = 0;
+};
+
+// The aggregate engine with its batches spread back into one move per ant
+class AggregateEngine : public StepEngine {
+public:
+    AggregateEngine(const ColonyInfo& colony, bool eventDriven)
+        : simulation(colony, eventDriven), stepLimit(simulationStepLimit(colony)) {}
+
+    bool reachable() const { return simulation.finished() || simulation.reachable(); }
+
+    bool step(vector<Move>& moves) override {
+        moves.clear();
+        if (simulation.finished() || stepsDone >= stepLimit || !simulation.step(batches)) return false;
+        for (const Batch& batch : batches.batches) {
+            for (int k = 0; k < batch.count; k++) {
+                moves.push_back({batches.antOf(batch, k), batch.from, batch.to});
+            }
+        }
+        stepsDone++;
+        return true;
+    }
+
+private:
+    AggregateSimulation simulation;
+    AggregateStep batches;
+    int64_t stepLimit;
+    int64_t stepsDone = 0;
+};
+
+} // namespace
+
+bool Colony::load(const string& filename) {
+    ColonyInfo loaded;
+    if (!loadColonyFromFile(loaded, filename)) return false;
+    colony = loaded;
+    return true;
+}
+
+bool Colony::parse(const char* data, size_t size) {
+    ColonyInfo loaded;
+    if (!loadColonyFromBuffer(loaded, data, size)) return false;
+    colony = loaded;
+    return true;
+}
+
+Simulation::Simulation(const Colony& colony, const SimulationOptions& options) : Simulation(colony.info(), options) {}
+
+Simulation::Simulation(const ColonyInfo& source, const SimulationOptions& options) : colony(source) {
+    if (options.solver == "flow" || options.solver == "paths") {
+        Schedule schedule;
+        bool solved;
+        if (options.solver == "flow") {
+            solved = solveWithTimeExpandedFlow(colony, schedule, options.lowerBound);
+        } else if (options.segments) {
+            solved = solveWithSegments(colony, schedule, options.lowerBound, options.plannerThreads);
+        } else if (!options.routeCache.empty()) {
+            solved = solveWithRouteCache(colony, options.routeCache, schedule, options.lowerBound);
+        } else {
+            solved = solveWithRoutes(colony, schedule, options.lowerBound);
+        }
+        if (solved) engine = make_unique<ScheduleEngine>(schedule);
+    } else if (options.solver == "aggregate" || options.solver == "events") {
+        colony = withoutDeadRooms(source);
+        unique_ptr<AggregateEngine> aggregate = make_unique<AggregateEngine>(colony, options.solver == "events");
+        if (aggregate->reachable()) engine = move(aggregate);
+    } else if (options.solver == "greedy") {
+        colony = withoutDeadRooms(source);
+        ants = AntTable(colony.numAnts);
+        // Ants that can never leave Sv have no plan, as with the other solvers
+        if (colony.numAnts > 0 && colony.dormitoryDistance[VESTIBULE] == UNREACHABLE) return;
+        if (options.strategy == STRATEGY_BFS && options.plannerThreads > 0) {
+            engine = makeParallelGreedyEngine(colony, ants, options.plannerThreads);
+        } else {
+            engine = makeStrategyEngine(colony, ants, options.strategy);
+        }
+    }
+}
+
+Simulation::~Simulation() {}
+
+ArrayView<Move> Simulation::step() {
+    moves.clear();
+    if (!engine || done) return ArrayView<Move>();
+    if (!engine->step(moves)) {
+        done = true;
+        return ArrayView<Move>();
+    }
+    steps++;
+    return moves;
+}
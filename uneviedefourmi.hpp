@@ -0,0 +1,69 @@
+#ifndef UNEVIEDEFOURMI_H
+#define UNEVIEDEFOURMI_H
+
+#include "ants.hpp"
+#include "strategies.hpp"
+
+class StepEngine;
+
+// Entry point of libuneviedefourmi for programs that embed the simulation. Nothing in the
+// library is global: each Colony and each Simulation is self-contained, so a process can run
+// as many as it likes, on as many threads.
+
+// A loaded colony: rooms, capacities, tunnels and the number of ants. It does not change once
+// loaded, so any number of simulations can run on it at the same time.
+class Colony {
+public:
+    Colony() {}
+    explicit Colony(const ColonyInfo& colony) : colony(colony) {}
+
+    bool load(const string& filename);         // Text colony or compiled .uvc file
+    bool parse(const char* data, size_t size); // Text colony held in memory
+
+    const ColonyInfo& info() const { return colony; }
+    int antCount() const { return colony.numAnts; }
+    size_t roomCount() const { return colony.roomCount(); }
+    string_view roomName(RoomId room) const { return colony.roomName(room); }
+
+private:
+    ColonyInfo colony;
+};
+
+struct SimulationOptions {
+    string solver = "greedy";             // One of solverNames()
+    PathStrategy strategy = STRATEGY_BFS; // Greedy solver only
+    size_t plannerThreads = 0;            // Greedy solver with the bfs strategy, or paths with segments
+    int64_t lowerBound = 0;               // computeStepLowerBound, lets flow and paths stop early
+    string routeCache;                    // Paths solver only: directory of its on-disk cache (route_cache.hpp)
+    bool segments = false;                // Paths solver only: plan segment by segment (planSegmentRoutes)
+};
+
+// One run of a solver on a colony: the ants, the occupancy of the rooms and whatever the solver
+// keeps from one step to the next. Moves come out one step at a time; the flow and paths
+// solvers plan everything up front, in the constructor.
+class Simulation {
+public:
+    explicit Simulation(const Colony& colony, const SimulationOptions& options = SimulationOptions());
+    explicit Simulation(const ColonyInfo& colony, const SimulationOptions& options = SimulationOptions());
+    ~Simulation();
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // False when the solver found no way to Sd (or is unknown): there is no step to take
+    bool reachable() const { return engine != nullptr; }
+
+    // Moves of the next step, valid until the next call; empty once no ant can move any more
+    ArrayView<Move> step();
+
+    size_t stepCount() const { return steps; }
+
+private:
+    ColonyInfo colony; // Shares the arrays of the colony it was given, which may go away first
+    AntTable ants;
+    unique_ptr<StepEngine> engine;
+    vector<Move> moves;
+    size_t steps = 0;
+    bool done = false;
+};
+
+#endif // UNEVIEDEFOURMI_H